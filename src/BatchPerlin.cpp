@@ -0,0 +1,274 @@
+#include "BatchPerlin.h"
+#include <cmath>
+#include <cstdint>
+
+#if defined(__AVX2__)
+#define BATCH_PERLIN_AVX2
+#include <immintrin.h>
+#elif defined(__SSE2__) || defined(_M_X64)
+#define BATCH_PERLIN_SSE2
+#include <emmintrin.h>
+#endif
+
+//libnoise's gradient table, 256 rows of (x, y, z, 0), defined in its noisegen.cpp from vectortable.h
+namespace noise {
+extern double g_randomVectors[256 * 4];
+}
+
+//libnoise's lattice hash: (X * x + Y * y + Z * z + SEED * seed), folded to 8 bits. y is always 0 here.
+static const int32_t X_NOISE_GEN = 1619;
+static const int32_t Z_NOISE_GEN = 6971;
+static const int32_t SEED_NOISE_GEN = 1013;
+//libnoise scales gradient noise by this to roughly fill [-1, 1]
+static const float GRADIENT_SCALE = 2.12f;
+
+//The x and z columns of libnoise's gradient table, in float
+struct GradientTable {
+    alignas(32) float x[256];
+    alignas(32) float z[256];
+
+    GradientTable() {
+        for(int i = 0; i < 256; i++){
+            x[i] = (float)noise::g_randomVectors[i * 4];
+            z[i] = (float)noise::g_randomVectors[i * 4 + 2];
+        }
+    }
+};
+
+static const GradientTable &getGradients()
+{
+    static const GradientTable gradients;
+    return gradients;
+}
+
+//The operations of the noise on WIDTH points at once, one struct per instruction set.
+//Lattice hashes only keep their low 16 bits, all the 8 bit table index depends on.
+struct ScalarLanes {
+    static const int WIDTH = 1;
+    typedef float Float;
+    typedef int32_t Int;
+
+    static Float load(const float *p) { return *p; }
+    static void store(float *p, Float v) { *p = v; }
+    static Float set(float v) { return v; }
+    static Float add(Float a, Float b) { return a + b; }
+    static Float sub(Float a, Float b) { return a - b; }
+    static Float mul(Float a, Float b) { return a * b; }
+    //floor(v) as an int, and as a float in floored
+    static Int floorToInt(Float v, Float &floored) {
+        Int i = (Int)v;
+        if((Float)i > v) i--;
+        floored = (Float)i;
+        return i;
+    }
+    static Int hash(Int x, Int z, int32_t seedTerm) {
+        return (Int)((uint32_t)x * X_NOISE_GEN + (uint32_t)z * Z_NOISE_GEN + (uint32_t)seedTerm);
+    }
+    static Int addInt(Int h, int32_t value) { return (Int)((uint32_t)h + (uint32_t)value); }
+    static Float gather(const float *table, Int h) { return table[(h ^ (h >> 8)) & 0xff]; }
+};
+
+#ifdef BATCH_PERLIN_SSE2
+struct Sse2Lanes {
+    static const int WIDTH = 4;
+    typedef __m128 Float;
+    typedef __m128i Int;
+
+    static Float load(const float *p) { return _mm_loadu_ps(p); }
+    static void store(float *p, Float v) { _mm_storeu_ps(p, v); }
+    static Float set(float v) { return _mm_set1_ps(v); }
+    static Float add(Float a, Float b) { return _mm_add_ps(a, b); }
+    static Float sub(Float a, Float b) { return _mm_sub_ps(a, b); }
+    static Float mul(Float a, Float b) { return _mm_mul_ps(a, b); }
+    //SSE2 has no floor, truncate and step down where that rounded up
+    static Int floorToInt(Float v, Float &floored) {
+        Int i = _mm_cvttps_epi32(v);
+        Int roundedUp = _mm_castps_si128(_mm_cmpgt_ps(_mm_cvtepi32_ps(i), v));
+        i = _mm_add_epi32(i, roundedUp);
+        floored = _mm_cvtepi32_ps(i);
+        return i;
+    }
+    //16 bit multiplies, SSE2 has no 32 bit one and the low 16 bits are the same
+    static Int hash(Int x, Int z, int32_t seedTerm) {
+        Int h = _mm_add_epi32(_mm_mullo_epi16(x, _mm_set1_epi32(X_NOISE_GEN)), _mm_mullo_epi16(z, _mm_set1_epi32(Z_NOISE_GEN)));
+        return _mm_add_epi32(h, _mm_set1_epi32(seedTerm));
+    }
+    static Int addInt(Int h, int32_t value) { return _mm_add_epi32(h, _mm_set1_epi32(value)); }
+    static Float gather(const float *table, Int h) {
+        alignas(16) int32_t index[4];
+        _mm_store_si128((Int *)index, _mm_and_si128(_mm_xor_si128(h, _mm_srli_epi32(h, 8)), _mm_set1_epi32(0xff)));
+        return _mm_set_ps(table[index[3]], table[index[2]], table[index[1]], table[index[0]]);
+    }
+};
+#endif
+
+#ifdef BATCH_PERLIN_AVX2
+struct Avx2Lanes {
+    static const int WIDTH = 8;
+    typedef __m256 Float;
+    typedef __m256i Int;
+
+    static Float load(const float *p) { return _mm256_loadu_ps(p); }
+    static void store(float *p, Float v) { _mm256_storeu_ps(p, v); }
+    static Float set(float v) { return _mm256_set1_ps(v); }
+    static Float add(Float a, Float b) { return _mm256_add_ps(a, b); }
+    static Float sub(Float a, Float b) { return _mm256_sub_ps(a, b); }
+    static Float mul(Float a, Float b) { return _mm256_mul_ps(a, b); }
+    static Int floorToInt(Float v, Float &floored) {
+        floored = _mm256_floor_ps(v);
+        return _mm256_cvtps_epi32(floored);
+    }
+    static Int hash(Int x, Int z, int32_t seedTerm) {
+        Int h = _mm256_add_epi32(_mm256_mullo_epi32(x, _mm256_set1_epi32(X_NOISE_GEN)), _mm256_mullo_epi32(z, _mm256_set1_epi32(Z_NOISE_GEN)));
+        return _mm256_add_epi32(h, _mm256_set1_epi32(seedTerm));
+    }
+    static Int addInt(Int h, int32_t value) { return _mm256_add_epi32(h, _mm256_set1_epi32(value)); }
+    static Float gather(const float *table, Int h) {
+        Int index = _mm256_and_si256(_mm256_xor_si256(h, _mm256_srli_epi32(h, 8)), _mm256_set1_epi32(0xff));
+        return _mm256_i32gather_ps(table, index, 4);
+    }
+};
+typedef Avx2Lanes BatchLanes;
+#elif defined(BATCH_PERLIN_SSE2)
+typedef Sse2Lanes BatchLanes;
+#else
+typedef ScalarLanes BatchLanes;
+#endif
+
+//libnoise's interpolation curve for each NoiseQuality, of a in [0, 1]
+template <typename Lanes>
+static typename Lanes::Float sCurve(typename Lanes::Float a, noise::NoiseQuality quality)
+{
+    typedef Lanes L;
+    switch(quality){
+    case noise::QUALITY_FAST:
+        return a;
+    case noise::QUALITY_STD: // a^2 (3 - 2a)
+        return L::mul(L::mul(a, a), L::sub(L::set(3.0f), L::add(a, a)));
+    default: // a^3 (a (6a - 15) + 10)
+        return L::mul(L::mul(L::mul(a, a), a), L::add(L::mul(a, L::sub(L::mul(a, L::set(6.0f)), L::set(15.0f))), L::set(10.0f)));
+    }
+}
+
+//Gradient of the lattice point with hash h, dotted with the offset (dx, 0, dz) to it
+template <typename Lanes>
+static typename Lanes::Float gradientNoise(const GradientTable &gradients, typename Lanes::Int h, typename Lanes::Float dx, typename Lanes::Float dz)
+{
+    typedef Lanes L;
+    return L::add(L::mul(L::gather(gradients.x, h), dx), L::mul(L::gather(gradients.z, h), dz));
+}
+
+BatchPerlin::BatchPerlin()
+    : frequency((float)noise::module::DEFAULT_PERLIN_FREQUENCY), lacunarity((float)noise::module::DEFAULT_PERLIN_LACUNARITY),
+      persistence((float)noise::module::DEFAULT_PERLIN_PERSISTENCE), octaveCount(noise::module::DEFAULT_PERLIN_OCTAVE_COUNT),
+      seed(noise::module::DEFAULT_PERLIN_SEED), quality(noise::module::DEFAULT_PERLIN_QUALITY)
+{
+}
+
+BatchPerlin::BatchPerlin(const noise::module::Perlin &perlin)
+    : frequency((float)perlin.GetFrequency()), lacunarity((float)perlin.GetLacunarity()),
+      persistence((float)perlin.GetPersistence()), octaveCount(perlin.GetOctaveCount()),
+      seed(perlin.GetSeed()), quality(perlin.GetNoiseQuality())
+{
+}
+
+int BatchPerlin::getBatchSize()
+{
+    return BatchLanes::WIDTH;
+}
+
+const char *BatchPerlin::getInstructionSetName()
+{
+#if defined(BATCH_PERLIN_AVX2)
+    return "AVX2";
+#elif defined(BATCH_PERLIN_SSE2)
+    return "SSE2";
+#else
+    return "scalar";
+#endif
+}
+
+//Lanes::WIDTH points, the octave loop of module::Perlin::GetValue over octaves [firstOctave, octaveEnd)
+template <typename Lanes>
+void BatchPerlin::getBatch(const float *xs, const float *zs, float *values, int firstOctave, int octaveEnd) const
+{
+    typedef Lanes L;
+    typedef typename L::Float Float;
+    typedef typename L::Int Int;
+    const GradientTable &gradients = getGradients();
+
+    Float x = L::mul(L::load(xs), L::set(frequency));
+    Float z = L::mul(L::load(zs), L::set(frequency));
+    Float value = L::set(0.0f);
+    Float one = L::set(1.0f);
+    float amplitude = GRADIENT_SCALE;
+    //Skipped octaves only scale, the same steps as evaluating them
+    for(int octave = 0; octave < firstOctave; octave++){
+        x = L::mul(x, L::set(lacunarity));
+        z = L::mul(z, L::set(lacunarity));
+        amplitude *= persistence;
+    }
+    for(int octave = firstOctave; octave < octaveEnd; octave++){
+        int32_t seedTerm = (int32_t)((uint32_t)(seed + octave) * SEED_NOISE_GEN);
+
+        //Lattice cell and position in it
+        Float x0, z0;
+        Int ix = L::floorToInt(x, x0);
+        Int iz = L::floorToInt(z, z0);
+        Float fx = L::sub(x, x0);
+        Float fz = L::sub(z, z0);
+        Float sx = sCurve<Lanes>(fx, quality);
+        Float sz = sCurve<Lanes>(fz, quality);
+
+        //The cell's corners on the plane, neighbouring hashes are a constant apart
+        Int h00 = L::hash(ix, iz, seedTerm);
+        Int h10 = L::addInt(h00, X_NOISE_GEN);
+        Int h01 = L::addInt(h00, Z_NOISE_GEN);
+        Int h11 = L::addInt(h00, X_NOISE_GEN + Z_NOISE_GEN);
+        Float fx1 = L::sub(fx, one);
+        Float fz1 = L::sub(fz, one);
+        Float n00 = gradientNoise<Lanes>(gradients, h00, fx, fz);
+        Float n10 = gradientNoise<Lanes>(gradients, h10, fx1, fz);
+        Float n01 = gradientNoise<Lanes>(gradients, h01, fx, fz1);
+        Float n11 = gradientNoise<Lanes>(gradients, h11, fx1, fz1);
+
+        Float nz0 = L::add(n00, L::mul(sx, L::sub(n10, n00)));
+        Float nz1 = L::add(n01, L::mul(sx, L::sub(n11, n01)));
+        Float signal = L::add(nz0, L::mul(sz, L::sub(nz1, nz0)));
+        value = L::add(value, L::mul(signal, L::set(amplitude)));
+
+        x = L::mul(x, L::set(lacunarity));
+        z = L::mul(z, L::set(lacunarity));
+        amplitude *= persistence;
+    }
+    L::store(values, value);
+}
+
+void BatchPerlin::getValues(const float *x, const float *z, int count, float *values) const
+{
+    getValues(x, z, count, values, 0, octaveCount);
+}
+
+void BatchPerlin::getValues(const float *x, const float *z, int count, float *values, int firstOctave, int octaveEnd) const
+{
+    int k = 0;
+    for(; k + BatchLanes::WIDTH <= count; k += BatchLanes::WIDTH){
+        getBatch<BatchLanes>(x + k, z + k, values + k, firstOctave, octaveEnd);
+    }
+    for(; k < count; k++){
+        getBatch<ScalarLanes>(x + k, z + k, values + k, firstOctave, octaveEnd);
+    }
+}
+
+float BatchPerlin::getValue(float x, float z) const
+{
+    float value;
+    getBatch<ScalarLanes>(&x, &z, &value, 0, octaveCount);
+    return value;
+}
+
+float BatchPerlin::getInterpolationError(int octave, float spacing) const
+{
+    float scaledSpacing = spacing * frequency * std::pow(lacunarity, (float)octave);
+    return INTERPOLATION_ERROR * scaledSpacing * scaledSpacing * std::pow(persistence, (float)octave);
+}
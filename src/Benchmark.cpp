@@ -0,0 +1,576 @@
+#include "Benchmark.h"
+#include "Chunk.h"
+#include "World.h"
+#include "VertexArray.h"
+#include "WorldRenderer.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <glm/gtc/matrix_transform.hpp>
+#include <iostream>
+#include <memory>
+#include <random>
+
+typedef std::chrono::steady_clock Clock;
+
+static double elapsedMs(Clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+}
+
+//Generates and meshes a grid of landscape chunks the same way main.cpp builds the world
+static void runChunkBenchmark(const TerrainGenerator &terrain, ChunkStorageMode storageMode)
+{
+    const int GRID_SIZE = 8;
+    const int CHUNK_COUNT = GRID_SIZE * GRID_SIZE;
+    const MeshMode meshModes[] = {MeshMode_Naive, MeshMode_Culled, MeshMode_Greedy, MeshMode_Binary};
+    const int MESH_MODE_COUNT = sizeof(meshModes) / sizeof(meshModes[0]);
+
+    HeightTileCache heightCache;
+    HeightField heightField(terrain, heightCache);
+    double generateMs = 0.0, meshMs[MESH_MODE_COUNT] = {};
+    size_t vertexCount[MESH_MODE_COUNT] = {}, memoryUsage = 0;
+    for(int i = 0; i < GRID_SIZE; i++){
+        for(int j = 0; j < GRID_SIZE; j++){
+            Clock::time_point start = Clock::now();
+            std::unique_ptr<Chunk> chunk = std::make_unique<Chunk>(storageMode);
+            chunk->setupLandscape(heightField, Chunk::CHUNK_SIZE * (i + 2), Chunk::CHUNK_SIZE * (j + 2));
+            generateMs += elapsedMs(start);
+
+            for(int m = 0; m < MESH_MODE_COUNT; m++){
+                chunk->setMeshMode(meshModes[m]);
+                start = Clock::now();
+                std::vector<PackedVertex> vertices = chunk->render();
+                meshMs[m] += elapsedMs(start);
+                vertexCount[m] += vertices.size();
+            }
+            memoryUsage += chunk->getMemoryUsage();
+        }
+    }
+
+    //What the old Block*** layout cost: 8 byte Blocks plus the two levels of pointer arrays
+    size_t legacyMemory = ChunkStorage::CHUNK_VOLUME * sizeof(Block) + Chunk::CHUNK_SIZE * sizeof(Block **) + ChunkStorage::CHUNK_AREA * sizeof(Block *);
+
+    std::cout << "Chunk benchmark (" << CHUNK_COUNT << " chunks, " << (storageMode == ChunkStorageMode_Flat ? "flat" : "palette") << " storage)\n";
+    std::cout << "  generate:     " << generateMs / CHUNK_COUNT << " ms/chunk\n";
+    for(int m = 0; m < MESH_MODE_COUNT; m++){
+        std::cout << "  mesh " << ChunkMesher::getModeName(meshModes[m]) << ": " << meshMs[m] / CHUNK_COUNT << " ms/chunk, " << vertexCount[m] / CHUNK_COUNT / 2 << " triangles/chunk\n";
+    }
+    std::cout << "  voxel memory: " << memoryUsage / CHUNK_COUNT << " bytes/chunk (Block*** layout: " << legacyMemory << " bytes)\n";
+    std::cout << "  chunk object: " << sizeof(Chunk) << " bytes\n";
+}
+
+//Re-meshes one landscape chunk many times per mode, the cost of re-meshing an edited chunk
+static void runMesherMicrobenchmark(const TerrainGenerator &terrain)
+{
+    const int ITERATIONS = 200;
+    const MeshMode meshModes[] = {MeshMode_Naive, MeshMode_Culled, MeshMode_Greedy, MeshMode_Binary};
+
+    HeightTileCache heightCache;
+    HeightField heightField(terrain, heightCache);
+    Chunk chunk;
+    chunk.setupLandscape(heightField, Chunk::CHUNK_SIZE * 4, Chunk::CHUNK_SIZE * 4);
+
+    std::cout << "Mesher microbenchmark (1 chunk, " << ITERATIONS << " iterations)\n";
+    for(MeshMode meshMode : meshModes){
+        chunk.setMeshMode(meshMode);
+        Clock::time_point start = Clock::now();
+        size_t vertexCount = 0;
+        for(int i = 0; i < ITERATIONS; i++){
+            vertexCount += chunk.render().size();
+        }
+        double usPerMesh = elapsedMs(start) * 1000.0 / ITERATIONS;
+        std::cout << "  " << ChunkMesher::getModeName(meshMode) << ": " << usPerMesh << " us/mesh, " << vertexCount / ITERATIONS << " vertices\n";
+    }
+}
+
+//BatchPerlin against libnoise's Perlin through model::Plane, as height maps sample it: points per second,
+//how far apart the values are and how many blocks of generated chunks differ
+static void runNoiseBenchmark()
+{
+    const int POINT_COUNT = 1 << 18;
+    const int GRID_SIZE = 8;
+
+    module::Perlin perlin;
+    perlin.SetFrequency(0.01f);
+    model::Plane plane(perlin);
+    BatchPerlin batch(perlin);
+
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float> coordinate(-4096.0f, 4096.0f);
+    std::vector<float> xs(POINT_COUNT), zs(POINT_COUNT), values(POINT_COUNT);
+    for(int k = 0; k < POINT_COUNT; k++){
+        xs[k] = coordinate(random);
+        zs[k] = coordinate(random);
+    }
+
+    Clock::time_point start = Clock::now();
+    double maxError = 0.0;
+    std::vector<double> reference(POINT_COUNT);
+    for(int k = 0; k < POINT_COUNT; k++){
+        reference[k] = plane.GetValue(xs[k], zs[k]);
+    }
+    double libnoiseMs = elapsedMs(start);
+
+    start = Clock::now();
+    batch.getValues(xs.data(), zs.data(), POINT_COUNT, values.data());
+    double batchMs = elapsedMs(start);
+    for(int k = 0; k < POINT_COUNT; k++){
+        maxError = std::max(maxError, std::abs(reference[k] - values[k]));
+    }
+
+    //The same landscape chunks from both sources
+    TerrainGenerator libnoiseTerrain(HeightSource_Libnoise), batchTerrain(HeightSource_Batch);
+    HeightTileCache heightCache; // shared, the two sources have different keys
+    HeightField libnoiseHeights(libnoiseTerrain, heightCache), batchHeights(batchTerrain, heightCache);
+    HeightField *heightFields[2] = {&libnoiseHeights, &batchHeights};
+    double generateMs[2] = {};
+    int differentBlocks = 0;
+    for(int i = 0; i < GRID_SIZE; i++){
+        for(int j = 0; j < GRID_SIZE; j++){
+            Chunk chunks[2];
+            for(int t = 0; t < 2; t++){
+                start = Clock::now();
+                chunks[t].setupLandscape(*heightFields[t], Chunk::CHUNK_SIZE * (i + 2), Chunk::CHUNK_SIZE * (j + 2));
+                generateMs[t] += elapsedMs(start);
+            }
+            for(int x = 0; x < Chunk::CHUNK_SIZE; x++){
+                for(int y = 0; y < Chunk::CHUNK_SIZE; y++){
+                    for(int z = 0; z < Chunk::CHUNK_SIZE; z++){
+                        differentBlocks += chunks[0].getBlockType(x, y, z) != chunks[1].getBlockType(x, y, z);
+                    }
+                }
+            }
+        }
+    }
+
+    const int CHUNK_COUNT = GRID_SIZE * GRID_SIZE;
+    std::cout << "Noise benchmark (" << POINT_COUNT << " points, BatchPerlin " << BatchPerlin::getInstructionSetName() << " x" << BatchPerlin::getBatchSize() << ")\n";
+    std::cout << "  libnoise: " << POINT_COUNT / libnoiseMs / 1000.0 << " Mpoints/s, batch: " << POINT_COUNT / batchMs / 1000.0 << " Mpoints/s\n";
+    std::cout << "  max difference: " << maxError << "\n";
+    std::cout << "  generate: " << generateMs[0] / CHUNK_COUNT << " ms/chunk with libnoise, " << generateMs[1] / CHUNK_COUNT << " ms/chunk batched, "
+              << differentBlocks << " of " << CHUNK_COUNT * ChunkStorage::CHUNK_VOLUME << " blocks differ\n";
+}
+
+//Grid heights with the low octaves on a coarse lattice, for several error bounds, against libnoise's Perlin
+//sampled at every grid point by NoiseMapBuilderPlane: time per map, how far apart the heights are against the
+//error estimate and how many blocks of generated chunks differ from full resolution
+static void runMultiResolutionBenchmark()
+{
+    const int MAP_SIZE = 512;
+    const int MAP_X0 = -256, MAP_Z0 = 1024;
+    const int GRID_SIZE = 8;
+    const float errorBounds[] = {0.0f, 0.005f, 0.02f, 0.05f};
+    const double ROUNDING = 1e-4; // BatchPerlin's float rounding against libnoise, on top of the estimate
+
+    //Bounds one step per grid point, so the builder samples exactly the integer grid
+    module::Perlin perlin;
+    perlin.SetFrequency(0.01f);
+    utils::NoiseMap reference;
+    utils::NoiseMapBuilderPlane builder;
+    builder.SetSourceModule(perlin);
+    builder.SetDestNoiseMap(reference);
+    builder.SetDestSize(MAP_SIZE, MAP_SIZE);
+    builder.SetBounds(MAP_X0, MAP_X0 + MAP_SIZE, MAP_Z0, MAP_Z0 + MAP_SIZE);
+    Clock::time_point start = Clock::now();
+    builder.Build();
+    double referenceMs = elapsedMs(start);
+
+    std::cout << "Multi-resolution benchmark (" << MAP_SIZE << " x " << MAP_SIZE << " grid, " << GRID_SIZE * GRID_SIZE << " chunks)\n";
+    std::cout << "  NoiseMapBuilderPlane: " << referenceMs << " ms\n";
+
+    HeightTileCache heightCache; // shared, every bound has its own key
+    TerrainGenerator fullTerrain;
+    HeightField fullHeights(fullTerrain, heightCache);
+    std::vector<float> heights(MAP_SIZE * MAP_SIZE);
+    for(float bound : errorBounds){
+        TerrainGenerator terrain(HeightSource_Batch, bound);
+        start = Clock::now();
+        terrain.getGridHeights(MAP_X0, MAP_Z0, MAP_SIZE, MAP_SIZE, heights.data());
+        double gridMs = elapsedMs(start);
+
+        double maxError = 0.0;
+        for(int z = 0; z < MAP_SIZE; z++){
+            const float *row = reference.GetConstSlabPtr(z);
+            for(int x = 0; x < MAP_SIZE; x++){
+                maxError = std::max(maxError, (double)std::abs(row[x] - heights[z * MAP_SIZE + x]));
+            }
+        }
+
+        HeightField coarseHeights(terrain, heightCache);
+        int differentBlocks = 0;
+        for(int i = 0; i < GRID_SIZE; i++){
+            for(int j = 0; j < GRID_SIZE; j++){
+                Chunk full, coarse;
+                full.setupLandscape(fullHeights, Chunk::CHUNK_SIZE * (i + 2), Chunk::CHUNK_SIZE * (j + 2));
+                coarse.setupLandscape(coarseHeights, Chunk::CHUNK_SIZE * (i + 2), Chunk::CHUNK_SIZE * (j + 2));
+                for(int x = 0; x < Chunk::CHUNK_SIZE; x++){
+                    for(int y = 0; y < Chunk::CHUNK_SIZE; y++){
+                        for(int z = 0; z < Chunk::CHUNK_SIZE; z++){
+                            differentBlocks += full.getBlockType(x, y, z) != coarse.getBlockType(x, y, z);
+                        }
+                    }
+                }
+            }
+        }
+
+        std::string spacings;
+        for(int octave = 0; octave < perlin.GetOctaveCount(); octave++){
+            spacings += (octave ? " " : "") + std::to_string(terrain.getOctaveSpacing(octave));
+        }
+        std::cout << "  bound " << bound << " (octave spacings " << spacings << "): " << gridMs << " ms, max difference " << maxError
+                  << " (estimate " << terrain.getCoarseError() << (maxError <= terrain.getCoarseError() + ROUNDING ? ", within" : ", EXCEEDED") << "), "
+                  << differentBlocks << " blocks differ\n";
+    }
+}
+
+//Builds one large height map (map export size) with libnoise on the calling thread and with a pool helping
+static void runHeightMapBenchmark()
+{
+    const int MAP_SIZE = 1024;
+    TerrainGenerator terrain(HeightSource_Libnoise);
+
+    utils::NoiseMap serialMap, pooledMap;
+    Clock::time_point start = Clock::now();
+    terrain.getHeightMap(0.0, 0.0, MAP_SIZE, serialMap);
+    double serialMs = elapsedMs(start);
+
+    ThreadPool pool;
+    start = Clock::now();
+    terrain.getHeightMap(0.0, 0.0, MAP_SIZE, pooledMap, &pool);
+    double pooledMs = elapsedMs(start);
+
+    bool identical = true;
+    for(int z = 0; z < MAP_SIZE; z++){
+        identical = identical && std::memcmp(serialMap.GetConstSlabPtr(z), pooledMap.GetConstSlabPtr(z), MAP_SIZE * sizeof(float)) == 0;
+    }
+
+    std::cout << "Height map benchmark (" << MAP_SIZE << " x " << MAP_SIZE << ")\n";
+    std::cout << "  build: " << serialMs << " ms on 1 thread, " << pooledMs << " ms with " << pool.getThreadCount() << " pool threads helping\n";
+    std::cout << "  pooled map " << (identical ? "identical" : "DIFFERENT") << "\n";
+}
+
+//Loads and meshes a grid of chunks through World, so faces between neighbouring chunks are culled
+static void runWorldBenchmark()
+{
+    const int GRID_SIZE = 8;
+
+    //Single worker against the default pool, loading includes generating and meshing every chunk
+    const int threadCounts[] = {1, 0};
+    std::unique_ptr<World> world;
+    double loadMs[2];
+    for(int t = 0; t < 2; t++){
+        Clock::time_point start = Clock::now();
+        world = std::make_unique<World>(GRID_SIZE, ChunkStorageMode_Flat, threadCounts[t]);
+        for(int i = 0; i < GRID_SIZE; i++){
+            for(int j = 0; j < GRID_SIZE; j++){
+                world->loadChunk(i, j);
+            }
+        }
+        world->finishJobs();
+        loadMs[t] = elapsedMs(start);
+    }
+
+    //The same chunks meshed without neighbours
+    int isolatedVertexCount = 0;
+    for(int i = 0; i < GRID_SIZE; i++){
+        for(int j = 0; j < GRID_SIZE; j++){
+            Chunk chunk;
+            chunk.setupLandscape(world->getHeightField(), Chunk::CHUNK_SIZE * (i + 2), Chunk::CHUNK_SIZE * (j + 2));
+            isolatedVertexCount += (int)chunk.render().size();
+        }
+    }
+
+    const MeshStats &stats = world->getMeshStats();
+    HeightFieldStats heightStats = world->getHeightField().getStats();
+    std::cout << "World benchmark (" << GRID_SIZE * GRID_SIZE << " chunks, " << ChunkMesher::getModeName(MeshMode_Culled) << ")\n";
+    std::cout << "  load: " << loadMs[0] << " ms with 1 worker, " << loadMs[1] << " ms with " << world->getThreadCount() << " workers\n";
+    std::cout << "  heights: " << heightStats.tilesGenerated << " tiles, " << heightStats.samplesGenerated / (GRID_SIZE * GRID_SIZE) << " noise samples/chunk\n";
+    std::cout << "  vertices: " << stats.vertexCount << " (" << isolatedVertexCount << " without neighbour culling)\n";
+}
+
+//Loads a world into an empty height cache, then again into the same cache, then with a cache too small for
+//it. The second load finds every tile, the small cache keeps evicting them.
+static void runHeightCacheBenchmark()
+{
+    const int GRID_SIZE = 8;
+    const int SMALL_CAPACITY = 4;
+
+    HeightTileCache sharedCache, smallCache(SMALL_CAPACITY);
+    HeightTileCache *caches[3] = {&sharedCache, &sharedCache, &smallCache};
+    const char *loadNames[3] = {"cold", "warm", "small cache"};
+    std::cout << "Height cache benchmark (" << GRID_SIZE * GRID_SIZE << " chunks, " << HeightField::TILE_SIZE << " x " << HeightField::TILE_SIZE << " tiles)\n";
+    for(int load = 0; load < 3; load++){
+        HeightTileCacheStats before = caches[load]->getStats();
+        World world(GRID_SIZE, ChunkStorageMode_Flat, 1, caches[load]);
+        Clock::time_point start = Clock::now();
+        for(int i = 0; i < GRID_SIZE; i++){
+            for(int j = 0; j < GRID_SIZE; j++){
+                world.loadChunk(i, j);
+            }
+        }
+        world.finishJobs();
+        double loadMs = elapsedMs(start);
+
+        HeightTileCacheStats after = caches[load]->getStats();
+        std::cout << "  " << loadNames[load] << ": " << loadMs << " ms, " << world.getHeightField().getStats().samplesGenerated << " noise samples, "
+                  << after.hits - before.hits << " hits, " << after.misses - before.misses << " misses, " << after.evictions - before.evictions << " evicted\n";
+    }
+}
+
+//Single block edits re-meshed through World against re-meshing the whole edited chunk
+static void runEditBenchmark()
+{
+    const int GRID_SIZE = 4;
+    const int EDITS = 500;
+
+    World world(GRID_SIZE);
+    for(int i = 0; i < GRID_SIZE; i++){
+        for(int j = 0; j < GRID_SIZE; j++){
+            world.loadChunk(i, j);
+        }
+    }
+    world.finishJobs();
+
+    std::mt19937 random(1);
+    double regionMs = 0.0, chunkMs = 0.0;
+    for(int e = 0; e < EDITS; e++){
+        int i = random() % GRID_SIZE, j = random() % GRID_SIZE;
+        int x = random() % Chunk::CHUNK_SIZE, y = random() % Chunk::CHUNK_SIZE, z = random() % Chunk::CHUNK_SIZE;
+
+        Clock::time_point start = Clock::now();
+        world.removeBlock(i, j, x, y, z);
+        world.processJobs();
+        regionMs += elapsedMs(start);
+
+        start = Clock::now();
+        world.getChunk(i, j)->render();
+        chunkMs += elapsedMs(start);
+    }
+
+    std::cout << "Edit benchmark (" << EDITS << " single block edits, " << ChunkMesher::getModeName(MeshMode_Culled) << ")\n";
+    std::cout << "  region re-mesh: " << regionMs * 1000.0 / EDITS << " us/edit, whole chunk re-mesh: " << chunkMs * 1000.0 / EDITS << " us/edit\n";
+}
+
+//CPU side of looking up every chunk's VBO for 3 passes a frame: string keys built per draw, as the per chunk
+//draw loop used to, against VBO handles resolved once. No GL calls, only the registry lookups.
+static void runSubmissionBenchmark()
+{
+    const int GRID_SIZE = 16;
+    const int PASSES = 3;
+    const int FRAMES = 1000;
+
+    VertexBufferRegistry registry;
+    std::vector<VBOHandle> handles;
+    for(int i = 0; i < GRID_SIZE; i++){
+        for(int j = 0; j < GRID_SIZE; j++){
+            std::string key = "Chunk" + std::to_string(i) + "_" + std::to_string(j);
+            handles.push_back(registry.add(key));
+            registry.at(handles.back()).size = i * GRID_SIZE + j;
+        }
+    }
+
+    long long checksum = 0;
+    Clock::time_point start = Clock::now();
+    for(int frame = 0; frame < FRAMES; frame++){
+        for(int pass = 0; pass < PASSES; pass++){
+            for(int i = 0; i < GRID_SIZE; i++){
+                for(int j = 0; j < GRID_SIZE; j++){
+                    std::string key = "Chunk" + std::to_string(i) + "_" + std::to_string(j);
+                    checksum += registry.at(registry.find(key)).size;
+                }
+            }
+        }
+    }
+    double keyUs = elapsedMs(start) * 1000.0 / FRAMES;
+
+    start = Clock::now();
+    for(int frame = 0; frame < FRAMES; frame++){
+        for(int pass = 0; pass < PASSES; pass++){
+            for(VBOHandle handle : handles){
+                checksum += registry.at(handle).size;
+            }
+        }
+    }
+    double handleUs = elapsedMs(start) * 1000.0 / FRAMES;
+
+    std::cout << "Submission benchmark (" << GRID_SIZE * GRID_SIZE * PASSES << " VBO lookups/frame)\n";
+    std::cout << "  string keys: " << keyUs << " us/frame, handles: " << handleUs << " us/frame (checksum " << checksum << ")\n";
+}
+
+//Chunks left after frustum culling as the world grows, seen from main.cpp's start camera and its projection
+static void runCullingBenchmark()
+{
+    const int gridSizes[] = {16, 32, 64};
+    const int ITERATIONS = 100;
+
+    glm::mat4 model = glm::scale(glm::mat4(1.0f), glm::vec3(20.0f));
+    glm::mat4 view = glm::lookAt(glm::vec3(0.0f, 0.0f, 3.0f), glm::vec3(0.0f, 0.0f, 2.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 200.0f);
+    Frustum frustum(projection * view * model);
+
+    std::cout << "Culling benchmark (start camera, 200 unit far plane)\n";
+    for(int gridSize : gridSizes){
+        int visible = 0;
+        Clock::time_point start = Clock::now();
+        for(int iteration = 0; iteration < ITERATIONS; iteration++){
+            visible = 0;
+            for(int i = 0; i < gridSize; i++){
+                for(int j = 0; j < gridSize; j++){
+                    glm::vec3 min, max;
+                    WorldRenderer::getChunkBounds(i, j, min, max);
+                    if(frustum.intersectsBox(min, max)) visible++;
+                }
+            }
+        }
+        double usPerPass = elapsedMs(start) * 1000.0 / ITERATIONS;
+        std::cout << "  " << gridSize << "x" << gridSize << ": " << visible << " drawn, " << gridSize * gridSize - visible << " culled, " << usPerPass << " us/pass\n";
+    }
+}
+
+//Occlusion culling of a loaded world the way WorldRenderer does it: the solid tiles of the nearest
+//frustum visible chunks are rasterized, then every frustum visible chunk is tested. CPU only, no GL.
+static void runOcclusionBenchmark()
+{
+    const int GRID_SIZE = 16;
+    const int OCCLUDER_CHUNKS = 16;
+    const int ITERATIONS = 100;
+
+    World world(GRID_SIZE);
+    for(int i = 0; i < GRID_SIZE; i++){
+        for(int j = 0; j < GRID_SIZE; j++){
+            world.loadChunk(i, j);
+        }
+    }
+    world.finishJobs();
+
+    //From the middle of the near edge looking across the world, just above the terrain and higher up
+    const int eyeI = GRID_SIZE / 2;
+    const ChunkHeights &eyeHeights = *world.getChunkHeights(eyeI, 0);
+    const float eyeBlocks[] = {eyeHeights.top + 2.0f, eyeHeights.top + 8.0f, Chunk::CHUNK_SIZE * 2.0f};
+    glm::mat4 model = glm::scale(glm::mat4(1.0f), glm::vec3(20.0f));
+    glm::mat4 projection = glm::perspective(glm::radians(45.0f), 800.0f / 600.0f, 0.1f, 200.0f);
+
+    std::cout << "Occlusion benchmark (" << GRID_SIZE << "x" << GRID_SIZE << " chunks, " << OcclusionCuller::WIDTH << "x" << OcclusionCuller::HEIGHT << " depth buffer)\n";
+    OcclusionCuller culler;
+    for(float blocks : eyeBlocks){
+        glm::vec3 eye = 20.0f * glm::vec3((float)eyeI, blocks / Chunk::CHUNK_SIZE - 0.5f, 0.0f);
+        glm::mat4 view = glm::lookAt(eye, eye + glm::vec3(0.0f, -0.1f, -1.0f), glm::vec3(0.0f, 1.0f, 0.0f));
+        glm::mat4 matrix = projection * view * model;
+        Frustum frustum(matrix);
+
+        int inFrustum = 0, occluded = 0;
+        Clock::time_point start = Clock::now();
+        for(int iteration = 0; iteration < ITERATIONS; iteration++){
+            std::vector<std::pair<float, glm::ivec2>> chunks;
+            for(int i = 0; i < GRID_SIZE; i++){
+                for(int j = 0; j < GRID_SIZE; j++){
+                    glm::vec3 min, max;
+                    WorldRenderer::getChunkBounds(i, j, *world.getChunkHeights(i, j), min, max);
+                    if(!frustum.intersectsBox(min, max)) continue;
+                    float w = (matrix * glm::vec4((float)i, 0.0f, (float)-j, 1.0f)).w;
+                    chunks.push_back(std::make_pair(w, glm::ivec2(i, j)));
+                }
+            }
+            size_t occluderCount = std::min(chunks.size(), (size_t)OCCLUDER_CHUNKS);
+            std::partial_sort(chunks.begin(), chunks.begin() + occluderCount, chunks.end(),
+                              [](const std::pair<float, glm::ivec2> &l, const std::pair<float, glm::ivec2> &r){ return l.first < r.first; });
+
+            culler.begin(matrix);
+            for(size_t o = 0; o < occluderCount; o++){
+                const ChunkHeights &heights = *world.getChunkHeights(chunks[o].second.x, chunks[o].second.y);
+                for(int tile = 0; tile < ChunkHeights::TILES * ChunkHeights::TILES; tile++){
+                    if(heights.solid[tile] == 0) continue;
+                    glm::vec3 min, max;
+                    WorldRenderer::getOccluderBounds(chunks[o].second.x, chunks[o].second.y, heights, tile, min, max);
+                    culler.addOccluder(min, max);
+                }
+            }
+            inFrustum = (int)chunks.size();
+            occluded = 0;
+            for(const std::pair<float, glm::ivec2> &chunk : chunks){
+                glm::vec3 min, max;
+                WorldRenderer::getChunkBounds(chunk.second.x, chunk.second.y, *world.getChunkHeights(chunk.second.x, chunk.second.y), min, max);
+                if(!culler.isVisible(min, max)) occluded++;
+            }
+        }
+        double usPerPass = elapsedMs(start) * 1000.0 / ITERATIONS;
+        const OcclusionStats &stats = culler.getStats();
+        std::cout << "  eye " << blocks << " blocks up: " << inFrustum << " in frustum, " << occluded << " occluded, "
+                  << stats.occluders << " occluders (" << stats.skippedOccluders << " skipped), " << usPerPass << " us/pass\n";
+    }
+}
+
+//Face connectivity of every chunk of a world, and the search for the chunks a camera reaches through air from
+//above the terrain and from a pocket dug under it
+static void runConnectivityBenchmark()
+{
+    const int GRID_SIZE = 16;
+    const int ITERATIONS = 100;
+
+    World world(GRID_SIZE);
+    for(int i = 0; i < GRID_SIZE; i++){
+        for(int j = 0; j < GRID_SIZE; j++){
+            world.loadChunk(i, j);
+        }
+    }
+    world.finishJobs();
+
+    Clock::time_point start = Clock::now();
+    for(int i = 0; i < GRID_SIZE; i++){
+        for(int j = 0; j < GRID_SIZE; j++){
+            ChunkConnectivity::compute(world.getChunk(i, j)->getStorage());
+        }
+    }
+    double computeUs = elapsedMs(start) * 1000.0 / (GRID_SIZE * GRID_SIZE);
+
+    //A sealed tunnel along x through the middle row of chunks, dug through 3 layers of stone
+    const int middle = GRID_SIZE / 2;
+    for(int i = 0; i < GRID_SIZE; i++){
+        for(int x = 0; x < Chunk::CHUNK_SIZE; x++){
+            for(int y = 0; y < 3; y++){
+                for(int z = Chunk::CHUNK_SIZE / 2 - 1; z <= Chunk::CHUNK_SIZE / 2 + 1; z++){
+                    world.setBlock(i, middle, x, y, z, BlockType_Stone);
+                }
+            }
+            world.removeBlock(i, middle, x, 1, Chunk::CHUNK_SIZE / 2);
+        }
+    }
+    world.finishJobs();
+
+    const int eyeY[] = {world.getChunkHeights(middle, middle)->top, 1};
+    const char *eyeNames[] = {"above the terrain", "in a tunnel"};
+    std::cout << "Connectivity benchmark (" << GRID_SIZE << "x" << GRID_SIZE << " chunks)\n";
+    std::cout << "  flood fill: " << computeUs << " us/chunk\n";
+    for(int e = 0; e < 2; e++){
+        std::vector<bool> visible;
+        start = Clock::now();
+        for(int iteration = 0; iteration < ITERATIONS; iteration++){
+            world.findVisibleChunks(middle, middle, 0, eyeY[e], Chunk::CHUNK_SIZE / 2, visible);
+        }
+        double usPerSearch = elapsedMs(start) * 1000.0 / ITERATIONS;
+        int reachable = 0;
+        for(bool chunk : visible) reachable += chunk;
+        std::cout << "  camera " << eyeNames[e] << ": " << reachable << " chunks reachable, " << usPerSearch << " us/search\n";
+    }
+}
+
+void runBenchmarks()
+{
+    TerrainGenerator terrain;
+    runChunkBenchmark(terrain, ChunkStorageMode_Flat);
+    runChunkBenchmark(terrain, ChunkStorageMode_Palette);
+    runMesherMicrobenchmark(terrain);
+    runNoiseBenchmark();
+    runHeightMapBenchmark();
+    runMultiResolutionBenchmark();
+    runWorldBenchmark();
+    runHeightCacheBenchmark();
+    runEditBenchmark();
+    runSubmissionBenchmark();
+    runCullingBenchmark();
+    runOcclusionBenchmark();
+    runConnectivityBenchmark();
+}
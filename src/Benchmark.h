@@ -0,0 +1,7 @@
+#ifndef __BENCHMARK_H__
+#define __BENCHMARK_H__
+
+//CPU side benchmarks that do not need a window, run with: ./app --bench
+void runBenchmarks();
+
+#endif // __BENCHMARK_H__
@@ -1,6 +1,8 @@
 #ifndef __BLOCK_H__
 #define __BLOCK_H__
 
+#include <cstdint>
+
 enum BlockType {
     BlockType_Default = 0,
     BlockType_Grass,
@@ -14,6 +16,13 @@ enum BlockType {
     BlockType_Snow,
 };
 
+//Compact 1 byte block id used by chunk storage. 0 is air (inactive), otherwise BlockType + 1.
+typedef uint8_t BlockId;
+const BlockId BlockId_Air = 0;
+
+inline BlockId toBlockId(BlockType type) { return (BlockId)(type + 1); }
+inline BlockType toBlockType(BlockId id) { return (BlockType)(id - 1); }
+
 
 class Block {
 public:
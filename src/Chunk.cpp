@@ -1,50 +1,5 @@
 #include "Chunk.h"
 
-
-std::vector<float> cube = {
-    -0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,
-     0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f, 
-     0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f, 
-     0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f, 
-    -0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f, 
-    -0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f, 
-
-    -0.5f, -0.5f,  0.5f,  0.0f,  0.0f, 1.0f,
-     0.5f, -0.5f,  0.5f,  0.0f,  0.0f, 1.0f,
-     0.5f,  0.5f,  0.5f,  0.0f,  0.0f, 1.0f,
-     0.5f,  0.5f,  0.5f,  0.0f,  0.0f, 1.0f,
-    -0.5f,  0.5f,  0.5f,  0.0f,  0.0f, 1.0f,
-    -0.5f, -0.5f,  0.5f,  0.0f,  0.0f, 1.0f,
-
-    -0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,
-    -0.5f,  0.5f, -0.5f, -1.0f,  0.0f,  0.0f,
-    -0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,
-    -0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,
-    -0.5f, -0.5f,  0.5f, -1.0f,  0.0f,  0.0f,
-    -0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,
-
-     0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,
-     0.5f,  0.5f, -0.5f,  1.0f,  0.0f,  0.0f,
-     0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,
-     0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,
-     0.5f, -0.5f,  0.5f,  1.0f,  0.0f,  0.0f,
-     0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,
-
-    -0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,
-     0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,
-     0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,
-     0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,
-    -0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,
-    -0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,
-
-    -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,
-     0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,
-     0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,
-     0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,
-    -0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,
-    -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f
-};
-
 std::map<BlockType, glm::vec3> BlockTypeToColorMap = 
 {
     {BlockType::BlockType_Default, glm::vec3(0.04f,0.44f,0.15f)},
@@ -55,48 +10,8 @@ std::map<BlockType, glm::vec3> BlockTypeToColorMap =
     {BlockType::BlockType_Snow, glm::vec3(1.0f,1.0f,1.0f)}
 };
 
-std::map<BlockType, int> BlockTypeToId = 
-{
-    {BlockType::BlockType_Sand, 0},
-    {BlockType::BlockType_Grass, 1},
-    {BlockType::BlockType_Stone, 2},
-    {BlockType::BlockType_Snow, 3}
-};
-
-Chunk::Chunk()
+Chunk::Chunk(ChunkStorageMode storageMode) : blocks(storageMode)
 {
-    pBlocks = new Block **[CHUNK_SIZE];
-    for(int i = 0; i < CHUNK_SIZE; i++){
-        pBlocks[i] = new Block *[CHUNK_SIZE];
-        for(int j = 0; j < CHUNK_SIZE; j++){
-            pBlocks[i][j] = new Block [CHUNK_SIZE];
-        }
-    }
-    setupHeightMap();
-}
-
-void Chunk::setupHeightMap(){
-
-  //Setup height map
-  myModule.SetFrequency(0.01f);
-  heightMapBuilder.SetSourceModule (myModule);
-  heightMapBuilder.SetDestNoiseMap (heightMap);
-  heightMapBuilder.SetDestSize (CHUNK_SIZE, CHUNK_SIZE);
-
-  //Set up the image renderer of the height map
-  rendererImage.SetSourceNoiseMap (heightMap);
-  rendererImage.SetDestImage (image);
-  rendererImage.ClearGradient ();
-  rendererImage.AddGradientPoint (-1.0000, utils ::Color (  0,   0, 128, 255)); // deeps
-  rendererImage.AddGradientPoint (-0.2500, utils::Color (  0,   0, 255, 255)); // shallow
-  rendererImage.AddGradientPoint ( 0.0000, utils::Color (  0, 128, 255, 255)); // shore
-  rendererImage.AddGradientPoint ( 0.0625, utils::Color (240, 240,  64, 255)); // sand
-  rendererImage.AddGradientPoint ( 0.1250, utils::Color ( 32, 160,   0, 255)); // grass
-  rendererImage.AddGradientPoint ( 0.3750, utils::Color (224, 224,   0, 255)); // dirt
-  rendererImage.AddGradientPoint ( 0.7500, utils::Color (128, 128, 128, 255)); // rock
-  rendererImage.AddGradientPoint ( 1.0000, utils::Color (255, 255, 255, 255)); // snow
-  writer.SetSourceImage (image);
-  writer.SetDestFilename ("tutorial.bmp");
 }
 
 BlockType Chunk::getBlockTypeFromHeight(int height)
@@ -115,13 +30,11 @@ BlockType Chunk::getBlockTypeFromHeight(int height)
 
 Chunk::~Chunk()
 {
-    for(int i = 0; i < CHUNK_SIZE; i++){
-        for(int j = 0; j < CHUNK_SIZE; j++){
-            delete[] pBlocks[i][j];
-        }
-        delete[] pBlocks[i];
-    }
-    delete[] pBlocks;
+}
+
+size_t Chunk::getMemoryUsage() const
+{
+    return blocks.getMemoryUsage();
 }
 
 void Chunk::update(float dt)
@@ -162,56 +75,44 @@ void Chunk::update(float dt)
 //     return vertices;
 // }
 
-std::vector<float> Chunk::render()
+std::vector<PackedVertex> Chunk::render()
 {
-    //Initialize VAO
-    std::vector<float> vertices;
-
-    //glm::mat4 rotationMat(1);
-    //rotationMat = glm::rotate(rotationMat, (float)glm::radians(90.0f), glm::vec3(0.0, 1.0, 0.0));
-
-    //Get Vertices 
-    int count = 0;
-    for(int x = 0; x < CHUNK_SIZE; x++){
-      for(int z = 0; z < CHUNK_SIZE; z++){
-        for(int y = 0; y < CHUNK_SIZE; y++){
-                if(pBlocks[x][y][z].isActive()){
-                    //std::cout << "Active at ( " << x << " , " << y << " , " << z << " ) :" << '\n';
-                    if(isHiddenBlock(x,y,z)) continue;
-                    count++;
-                    //Add vertex to VAO
-                    glm::vec3 modelCoord = glm::vec3(x, y, z); // from 0 to 31
-                    //modelCoord = glm::vec3(rotationMat * glm::vec4(modelCoord, 1.0));
-                    createCube(vertices, pBlocks[x][y][z], modelCoord);
-                }
-            }
-        }
-    }
-    
-    // std::cout << count << " Rendered\n";
-    //Bind a Vertex Buffer Object
-    return vertices;
+    updateHalo();
+    dirtyRegions = 0;
+    return ChunkMesher::mesh(blocks, halo, meshMode, meshStats);
 }
 
-void Chunk::createCube(std::vector<float> &vertices, Block block, glm::vec3 modelCoord)
+void Chunk::markBlockDirty(int x, int y, int z)
 {
-    
-    for(int i = 0; i < cube.size(); i+=6){
-        int x = (cube[i] + 0.5 + modelCoord.x); // [-0.5, 0.5] + 0.5 = [0,1] -> [0,1] + [0,31] = [0,32]
-        int y = (cube[i + 1] + 0.5 + modelCoord.y);
-        int z = (cube[i + 2] + 0.5 + modelCoord.z);
+    const int REGION_SIZE = ChunkMesher::REGION_SIZE;
+    dirtyRegions |= 1u << ChunkMesher::getRegionIndex(x, y, z);
+
+    //A block on a region border also changes the faces of the block across it
+    if(x % REGION_SIZE == 0 && x > 0) dirtyRegions |= 1u << ChunkMesher::getRegionIndex(x - 1, y, z);
+    if(x % REGION_SIZE == REGION_SIZE - 1 && x < CHUNK_SIZE - 1) dirtyRegions |= 1u << ChunkMesher::getRegionIndex(x + 1, y, z);
+    if(y % REGION_SIZE == 0 && y > 0) dirtyRegions |= 1u << ChunkMesher::getRegionIndex(x, y - 1, z);
+    if(y % REGION_SIZE == REGION_SIZE - 1 && y < CHUNK_SIZE - 1) dirtyRegions |= 1u << ChunkMesher::getRegionIndex(x, y + 1, z);
+    if(z % REGION_SIZE == 0 && z > 0) dirtyRegions |= 1u << ChunkMesher::getRegionIndex(x, y, z - 1);
+    if(z % REGION_SIZE == REGION_SIZE - 1 && z < CHUNK_SIZE - 1) dirtyRegions |= 1u << ChunkMesher::getRegionIndex(x, y, z + 1);
+}
 
-        int nx = (cube[i+3] == -1.0 ? 2 : cube[i+3]);
-        int ny = (cube[i+4] == -1.0 ? 2 : cube[i+4]);
-        int nz = (cube[i+5] == -1.0 ? 2 : cube[i+5]);
-        
-        int position = x | y << 6 | z << 12; //18 bits
-        int normal = nx | ny << 2 | nz << 4; //6 bits
-        int color = BlockTypeToId[block.getBlockType()]; //2 bits
+uint32_t Chunk::takeDirtyRegions()
+{
+    uint32_t regions = dirtyRegions;
+    dirtyRegions = 0;
+    return regions;
+}
 
-        int vertex = position | normal << 18 | color << 24; //  color (2 bits) + normal(6 bits) + position(18 bits) 
+void Chunk::updateHalo()
+{
+    halo = ChunkHalo();
 
-        vertices.push_back(vertex);
+    //The column touching this chunk is on the opposite border of the neighbour
+    for(int i = 0; i < CHUNK_SIZE; i++){
+        if(neighbours[ChunkSide_NegZ]) halo.border[ChunkSide_NegZ][i] = neighbours[ChunkSide_NegZ]->blocks.columnMask(i, CHUNK_SIZE - 1);
+        if(neighbours[ChunkSide_PosZ]) halo.border[ChunkSide_PosZ][i] = neighbours[ChunkSide_PosZ]->blocks.columnMask(i, 0);
+        if(neighbours[ChunkSide_NegX]) halo.border[ChunkSide_NegX][i] = neighbours[ChunkSide_NegX]->blocks.columnMask(CHUNK_SIZE - 1, i);
+        if(neighbours[ChunkSide_PosX]) halo.border[ChunkSide_PosX][i] = neighbours[ChunkSide_PosX]->blocks.columnMask(0, i);
     }
 }
 
@@ -245,8 +146,7 @@ void Chunk::setupSphere() {
     for (int y = 0; y < CHUNK_SIZE; y++) {
       for (int x = 0; x < CHUNK_SIZE; x++) {
         if (sqrt((float)(x - CHUNK_SIZE / 2) * (x - CHUNK_SIZE / 2) + (y - CHUNK_SIZE / 2) * (y - CHUNK_SIZE / 2) + (z - CHUNK_SIZE / 2) * (z - CHUNK_SIZE / 2)) <= CHUNK_SIZE / 2) {
-            pBlocks[x][y][z].setActive(true);
-            pBlocks[x][y][z].setBlockType(BlockType_Grass);
+            setBlock(x, y, z, BlockType_Grass);
         }
       }
     }
@@ -257,63 +157,34 @@ void Chunk::setupCube() {
   for (int z = 0; z < CHUNK_SIZE; z++) {
     for (int y = 0; y < CHUNK_SIZE; y++) {
       for (int x = 0; x < CHUNK_SIZE; x++) {
-        pBlocks[x][y][z].setActive(true);
-        pBlocks[x][y][z].setBlockType(BlockType_Grass);
+        setBlock(x, y, z, BlockType_Grass);
       }
     }
   }
 }
 
-void Chunk::setupLandscape(double dx, double dy) {
+void Chunk::setupLandscape(HeightField &heightField, int x0, int z0) {
 
-  //Noise
-  heightMapBuilder.SetBounds (dx, dx + CHUNK_SIZE - 1, dy, dy + CHUNK_SIZE - 1);
-  heightMapBuilder.Build ();
-  rendererImage.Render ();
-  // std::string key = "tutorial" + std::to_string((int)dx) + std::to_string((int)dy) + ".bmp";
-  // writer.SetDestFilename (key);
-  // writer.WriteDestFile ();
-  
-  //Get heightmap
-  //utils::NoiseMap heightMap = world->getHeightMap(dx, dx + CHUNK_SIZE - 1, dy, dy + CHUNK_SIZE - 1);
-  //utils::NoiseMap heightMap = world->getHeightMap(dx, dx + CHUNK_SIZE - 1, dy, dy + CHUNK_SIZE - 1);
+  //Noise, row r holds world z = z0 + r
+  float heightMap[CHUNK_SIZE * CHUNK_SIZE];
+  heightField.getHeights(x0, z0, CHUNK_SIZE, CHUNK_SIZE, heightMap);
 
   for (int x = 0; x < CHUNK_SIZE; x++) {
     for (int z = 0; z < CHUNK_SIZE; z++) { 
       // Use the noise library to get the height value of x, z                      
       // Use the height map texture to get the height value of x, z  
-      //float height = std::min((float)CHUNK_SIZE,(heightMap.GetValue(x + dx, z + dy) * (CHUNK_SIZE/2.0f) * 1.0f)); 
-      float height = std::min((float)CHUNK_SIZE,((heightMap.GetValue(x,CHUNK_SIZE - 1 - z)+1.0f) * (CHUNK_SIZE/2.0f) * 1.0f));
+      //Local z runs against world z, the chunk is drawn at -j
+      float height = std::min((float)CHUNK_SIZE,((heightMap[(CHUNK_SIZE - 1 - z) * CHUNK_SIZE + x]+1.0f) * (CHUNK_SIZE/2.0f) * 1.0f));
       for (int y = 0; y < height; y++) {
-        pBlocks[x][y][z].setActive(true);
-        pBlocks[x][y][z].setBlockType(getBlockTypeFromHeight((int)y));
+        blocks.set(x, y, z, toBlockId(getBlockTypeFromHeight(y)));
       }
     }
   }
+  dirtyRegions = ChunkMesher::ALL_REGIONS;
 }
 
 void Chunk::clearBlocks()
 {
-  for (int z = 0; z < CHUNK_SIZE; z++) {
-    for (int y = 0; y < CHUNK_SIZE; y++) {
-      for (int x = 0; x < CHUNK_SIZE; x++) {
-        pBlocks[x][y][z].setActive(false);
-      }
-    }
-  }
-}
-
-bool Chunk::isHiddenBlock(int x, int y, int z) const
-{
-  int hiddenCount = 0;
-  if(x > 0 && pBlocks[x-1][y][z].isActive()) hiddenCount++;
-  if(x < CHUNK_SIZE - 1 && pBlocks[x+1][y][z].isActive()) hiddenCount++;
-
-  if(y > 0 && pBlocks[x][y-1][z].isActive()) hiddenCount++;
-  if(y < CHUNK_SIZE - 1 && pBlocks[x][y+1][z].isActive()) hiddenCount++;
-
-  if(z > 0 && pBlocks[x][y][z-1].isActive()) hiddenCount++;
-  if(z < CHUNK_SIZE - 1 && pBlocks[x][y][z+1].isActive()) hiddenCount++;
-
-  return (hiddenCount == 6);
+  blocks.fill(BlockId_Air);
+  dirtyRegions = ChunkMesher::ALL_REGIONS;
 }
@@ -2,7 +2,10 @@
 #define __CHUNK_H__
 
 #include "Block.h"
+#include "ChunkStorage.h"
+#include "ChunkMesher.h"
 #include "Renderer.h"
+#include "HeightField.h"
 #include "vector"
 #include "map"
 
@@ -11,41 +14,65 @@
 #include <glm/gtc/type_ptr.hpp>
 #include <random>
 
-#include <noise/noise.h>
-#include "noiseutils.h"
-
 class Chunk {
-private:
-    bool isHiddenBlock(int x, int y, int z) const;
-    module::Perlin myModule;
-    utils::NoiseMap heightMap;
-    utils::NoiseMapBuilderPlane heightMapBuilder;
-    utils::RendererImage rendererImage;
-    utils::Image image;
-    utils::WriterBMP writer;
 public:
-    Chunk();
+    Chunk(ChunkStorageMode storageMode = ChunkStorageMode_Flat);
     ~Chunk();
     void update(float dt);
-    std::vector<float> render();
+
+    //Meshes the chunk with the current mesh mode, updating the mesh stats
+    std::vector<PackedVertex> render();
+
+    //Neighbouring chunks, nullptr when not loaded. Their border columns are copied into the halo before meshing.
+    void setNeighbour(ChunkSide side, Chunk *chunk) { neighbours[side] = chunk; }
+    Chunk *getNeighbour(ChunkSide side) const { return neighbours[side]; }
+    void updateHalo();
+    const ChunkHalo &getHalo() const { return halo; }
+    void setMeshMode(MeshMode mode) { meshMode = mode; }
+    MeshMode getMeshMode() const { return meshMode; }
+    const MeshStats &getMeshStats() const { return meshStats; }
+    //For meshes built outside render(), e.g. on a worker thread
+    void setMeshStats(const MeshStats &stats) { meshStats = stats; }
 
     //Helper Functions
-    void setupHeightMap();
     BlockType getBlockTypeFromHeight(int height);
 
     //Set up landscapes
     void setupSphere();
     void setupCube();
-    void setupLandscape(double dx = 0, double dy = 0);
+    //Columns up to the heights of the world grid points x in [x0, x0 + CHUNK_SIZE), z in [z0, z0 + CHUNK_SIZE)
+    void setupLandscape(HeightField &heightField, int x0 = 0, int z0 = 0);
 
     //Reset blocks
     void clearBlocks();
 
-    //Creates a cube (vector of floats at a position based on its index in chunk.
-    void createCube(std::vector<float> &vertices, Block block, glm::vec3 modelCoord);
-    static const int CHUNK_SIZE = 32;
+    //Block accessors, coordinates are local to the chunk in [0, CHUNK_SIZE).
+    //Edits mark the mesh regions they can change dirty, edits on the chunk border also change the neighbour (see World::setBlock).
+    bool isActive(int x, int y, int z) const { return blocks.isActive(x, y, z); }
+    BlockType getBlockType(int x, int y, int z) const { return toBlockType(blocks.get(x, y, z)); }
+    void setBlock(int x, int y, int z, BlockType type) { blocks.set(x, y, z, toBlockId(type)); markBlockDirty(x, y, z); }
+    void removeBlock(int x, int y, int z) { blocks.set(x, y, z, BlockId_Air); markBlockDirty(x, y, z); }
+    const ChunkStorage &getStorage() const { return blocks; }
+
+    //Bit r set when ChunkMesher::getRegion(r) needs re-meshing
+    uint32_t getDirtyRegions() const { return dirtyRegions; }
+    void markRegionsDirty(uint32_t regions) { dirtyRegions |= regions; }
+    //Marks the regions of block (x, y, z) and of the blocks next to it inside this chunk
+    void markBlockDirty(int x, int y, int z);
+    //Returns the dirty regions and clears them, for when their meshing is queued
+    uint32_t takeDirtyRegions();
+
+    //Bytes used by the voxel data of this chunk
+    size_t getMemoryUsage() const;
+
+    static const int CHUNK_SIZE = ChunkStorage::CHUNK_SIZE;
 private: // The blocks data
-    Block * * * pBlocks;
+    ChunkStorage blocks;
+    MeshMode meshMode = MeshMode_Culled;
+    MeshStats meshStats;
+    Chunk *neighbours[ChunkSide_Count] = {};
+    ChunkHalo halo;
+    uint32_t dirtyRegions = ChunkMesher::ALL_REGIONS;
 };
 
 
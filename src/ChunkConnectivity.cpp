@@ -0,0 +1,112 @@
+#include "ChunkConnectivity.h"
+#include <vector>
+
+static const int CHUNK_SIZE = ChunkStorage::CHUNK_SIZE;
+
+//Air of every column as bitmasks, bit y set for an air block
+struct AirColumns {
+    uint32_t air[CHUNK_SIZE][CHUNK_SIZE]; // [x][z]
+    uint32_t visited[CHUNK_SIZE][CHUNK_SIZE] = {};
+
+    explicit AirColumns(const ChunkStorage &blocks) {
+        for(int x = 0; x < CHUNK_SIZE; x++){
+            for(int z = 0; z < CHUNK_SIZE; z++){
+                air[x][z] = ~blocks.columnMask(x, z);
+            }
+        }
+    }
+};
+
+static uint32_t fillRuns(uint32_t seeds, uint32_t mask)
+{
+    uint32_t filled = seeds & mask;
+    while(true){
+        uint32_t grown = filled | (((filled << 1) | (filled >> 1)) & mask);
+        if(grown == filled) return filled;
+        filled = grown;
+    }
+}
+
+//Openings of side touched by the air bits of a column on it
+static uint32_t getSideOpenings(ChunkSide side, uint32_t bits)
+{
+    uint32_t openings = 0;
+    for(int band = 0; band < ChunkConnectivity::BANDS; band++){
+        uint32_t bandBits = ((1u << ChunkConnectivity::BAND_HEIGHT) - 1) << (band * ChunkConnectivity::BAND_HEIGHT);
+        if(bits & bandBits) openings |= 1u << ChunkConnectivity::getOpening(side, band * ChunkConnectivity::BAND_HEIGHT);
+    }
+    return openings;
+}
+
+//Visits the air pocket holding seed (bits of column (x, z)), returns the openings it touches
+static uint32_t floodFill(AirColumns &columns, int x, int z, uint32_t seed)
+{
+    struct Pending {
+        int x, z;
+        uint32_t bits;
+    };
+    std::vector<Pending> stack;
+
+    uint32_t start = fillRuns(seed, columns.air[x][z]) & ~columns.visited[x][z];
+    if(!start) return 0;
+    columns.visited[x][z] |= start;
+    stack.push_back(Pending{x, z, start});
+
+    uint32_t touched = 0;
+    while(!stack.empty()){
+        Pending column = stack.back();
+        stack.pop_back();
+
+        if(column.z == 0) touched |= getSideOpenings(ChunkSide_NegZ, column.bits);
+        if(column.z == CHUNK_SIZE - 1) touched |= getSideOpenings(ChunkSide_PosZ, column.bits);
+        if(column.x == 0) touched |= getSideOpenings(ChunkSide_NegX, column.bits);
+        if(column.x == CHUNK_SIZE - 1) touched |= getSideOpenings(ChunkSide_PosX, column.bits);
+        if(column.bits & 1u) touched |= 1u << ChunkConnectivity::BOTTOM;
+        if(column.bits >> (CHUNK_SIZE - 1)) touched |= 1u << ChunkConnectivity::TOP;
+
+        //The neighbouring columns' runs that share a y with the new bits join the pocket
+        const int offsets[4][2] = {{0, -1}, {0, 1}, {-1, 0}, {1, 0}};
+        for(const int *offset : offsets){
+            int nx = column.x + offset[0], nz = column.z + offset[1];
+            if(nx < 0 || nx >= CHUNK_SIZE || nz < 0 || nz >= CHUNK_SIZE) continue;
+            uint32_t added = fillRuns(column.bits, columns.air[nx][nz]) & ~columns.visited[nx][nz];
+            if(!added) continue;
+            columns.visited[nx][nz] |= added;
+            stack.push_back(Pending{nx, nz, added});
+        }
+    }
+    return touched;
+}
+
+ChunkConnectivity::ChunkConnectivity()
+{
+    for(uint32_t &openings : connected) openings = ALL_OPENINGS;
+}
+
+ChunkConnectivity ChunkConnectivity::compute(const ChunkStorage &blocks)
+{
+    AirColumns columns(blocks);
+    ChunkConnectivity connectivity;
+    for(uint32_t &openings : connectivity.connected) openings = 0;
+
+    for(int x = 0; x < CHUNK_SIZE; x++){
+        for(int z = 0; z < CHUNK_SIZE; z++){
+            //One pocket per unvisited run, most columns have a single run of air above the ground
+            uint32_t unvisited;
+            while((unvisited = columns.air[x][z] & ~columns.visited[x][z]) != 0){
+                uint32_t touched = floodFill(columns, x, z, unvisited & (~unvisited + 1));
+                for(int opening = 0; opening < OPENING_COUNT; opening++){
+                    if(touched & (1u << opening)) connectivity.connected[opening] |= touched;
+                }
+            }
+        }
+    }
+    return connectivity;
+}
+
+uint32_t ChunkConnectivity::getReachableOpenings(const ChunkStorage &blocks, int x, int y, int z)
+{
+    if(blocks.isActive(x, y, z)) return 0;
+    AirColumns columns(blocks);
+    return floodFill(columns, x, z, 1u << y);
+}
@@ -0,0 +1,38 @@
+#ifndef __CHUNKCONNECTIVITY_H__
+#define __CHUNKCONNECTIVITY_H__
+
+#include "ChunkMesher.h"
+
+//Which openings of a chunk can see each other through its air: two are connected when one pocket of air
+//(blocks joined through their faces) touches both. Found by flood filling the air, 32 blocks of a column
+//at a time.
+//Chunks are as tall as the world, so the air above the terrain touches every side. Each side is split into
+//BANDS bands of BAND_HEIGHT blocks so a tunnel deep underground stays apart from it.
+//Openings are numbered side * BANDS + band for the 4 ChunkSides, then BOTTOM and TOP.
+class ChunkConnectivity {
+public:
+    static const int BANDS = 4;
+    static const int BAND_HEIGHT = ChunkStorage::CHUNK_SIZE / BANDS;
+    static const int SIDE_OPENINGS = ChunkSide_Count * BANDS;
+    static const int BOTTOM = SIDE_OPENINGS;
+    static const int TOP = SIDE_OPENINGS + 1;
+    static const int OPENING_COUNT = SIDE_OPENINGS + 2;
+    static const uint32_t ALL_OPENINGS = (1u << OPENING_COUNT) - 1;
+
+    //Every opening connected to every other, for chunks whose blocks are not known yet
+    ChunkConnectivity();
+
+    static ChunkConnectivity compute(const ChunkStorage &blocks);
+    //Openings touched by the air pocket around block (x, y, z), 0 when the block is solid
+    static uint32_t getReachableOpenings(const ChunkStorage &blocks, int x, int y, int z);
+
+    static int getOpening(ChunkSide side, int y) { return side * BANDS + y / BAND_HEIGHT; }
+
+    //Bit o set for every opening o connected to from. Includes from itself when any air touches it.
+    uint32_t getConnected(int from) const { return connected[from]; }
+
+private:
+    uint32_t connected[OPENING_COUNT];
+};
+
+#endif // __CHUNKCONNECTIVITY_H__
@@ -0,0 +1,464 @@
+#include "ChunkMesher.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+
+//Unit cube as 6 faces of 6 vertices: x, y, z, nx, ny, nz
+//Face order: -z, +z, -x, +x, -y, +y
+//The triangles of each face are (0, 1, 2), (2, 4, 0), so vertices 0, 1, 2, 4 are the quad corners
+static const float cube[] = {
+    -0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f,
+     0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f, 
+     0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f, 
+     0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f, 
+    -0.5f,  0.5f, -0.5f,  0.0f,  0.0f, -1.0f, 
+    -0.5f, -0.5f, -0.5f,  0.0f,  0.0f, -1.0f, 
+
+    -0.5f, -0.5f,  0.5f,  0.0f,  0.0f, 1.0f,
+     0.5f, -0.5f,  0.5f,  0.0f,  0.0f, 1.0f,
+     0.5f,  0.5f,  0.5f,  0.0f,  0.0f, 1.0f,
+     0.5f,  0.5f,  0.5f,  0.0f,  0.0f, 1.0f,
+    -0.5f,  0.5f,  0.5f,  0.0f,  0.0f, 1.0f,
+    -0.5f, -0.5f,  0.5f,  0.0f,  0.0f, 1.0f,
+
+    -0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,
+    -0.5f,  0.5f, -0.5f, -1.0f,  0.0f,  0.0f,
+    -0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,
+    -0.5f, -0.5f, -0.5f, -1.0f,  0.0f,  0.0f,
+    -0.5f, -0.5f,  0.5f, -1.0f,  0.0f,  0.0f,
+    -0.5f,  0.5f,  0.5f, -1.0f,  0.0f,  0.0f,
+
+     0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,
+     0.5f,  0.5f, -0.5f,  1.0f,  0.0f,  0.0f,
+     0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,
+     0.5f, -0.5f, -0.5f,  1.0f,  0.0f,  0.0f,
+     0.5f, -0.5f,  0.5f,  1.0f,  0.0f,  0.0f,
+     0.5f,  0.5f,  0.5f,  1.0f,  0.0f,  0.0f,
+
+    -0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,
+     0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,
+     0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,
+     0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,
+    -0.5f, -0.5f,  0.5f,  0.0f, -1.0f,  0.0f,
+    -0.5f, -0.5f, -0.5f,  0.0f, -1.0f,  0.0f,
+
+    -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,
+     0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f,
+     0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,
+     0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,
+    -0.5f,  0.5f,  0.5f,  0.0f,  1.0f,  0.0f,
+    -0.5f,  0.5f, -0.5f,  0.0f,  1.0f,  0.0f
+};
+
+//Axis (0 = x, 1 = y, 2 = z) a face points along and whether it points to the positive side
+static int getFaceAxis(int face)
+{
+    static const int axes[ChunkMesher::FACE_COUNT] = {2, 2, 0, 0, 1, 1};
+    return axes[face];
+}
+
+static bool isPositiveFace(int face)
+{
+    return face % 2 == 1;
+}
+
+//Index of the lowest set bit, mask must not be 0
+static int countTrailingZeros(uint32_t mask)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_ctz(mask);
+#else
+    int count = 0;
+    while(!(mask & 1)){
+        mask >>= 1;
+        count++;
+    }
+    return count;
+#endif
+}
+
+static int countBits(uint32_t mask)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    return __builtin_popcount(mask);
+#else
+    int count = 0;
+    for(; mask; mask &= mask - 1) count++;
+    return count;
+#endif
+}
+
+MeshRegion ChunkMesher::getChunkRegion()
+{
+    MeshRegion region = {{0, 0, 0}, {CHUNK_SIZE, CHUNK_SIZE, CHUNK_SIZE}};
+    return region;
+}
+
+//Region index bits: x | z << 1 | y << 2
+MeshRegion ChunkMesher::getRegion(int index)
+{
+    int rx = index % REGIONS_PER_AXIS;
+    int rz = (index / REGIONS_PER_AXIS) % REGIONS_PER_AXIS;
+    int ry = index / (REGIONS_PER_AXIS * REGIONS_PER_AXIS);
+    MeshRegion region = {
+        {rx * REGION_SIZE, ry * REGION_SIZE, rz * REGION_SIZE},
+        {(rx + 1) * REGION_SIZE, (ry + 1) * REGION_SIZE, (rz + 1) * REGION_SIZE},
+    };
+    return region;
+}
+
+int ChunkMesher::getRegionIndex(int x, int y, int z)
+{
+    return x / REGION_SIZE + (z / REGION_SIZE + y / REGION_SIZE * REGIONS_PER_AXIS) * REGIONS_PER_AXIS;
+}
+
+std::vector<PackedVertex> ChunkMesher::mesh(const ChunkStorage &blocks, const ChunkHalo &halo, MeshMode mode, MeshStats &stats)
+{
+    return mesh(blocks, halo, mode, getChunkRegion(), stats);
+}
+
+std::vector<PackedVertex> ChunkMesher::mesh(const ChunkStorage &blocks, const ChunkHalo &halo, MeshMode mode, const MeshRegion &region, MeshStats &stats)
+{
+    std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    std::vector<PackedVertex> vertices;
+    stats = MeshStats();
+
+    if(mode == MeshMode_Naive){
+        meshNaive(blocks, halo, region, vertices, stats);
+    }else if(mode == MeshMode_Culled){
+        meshCulled(blocks, halo, region, vertices, stats);
+    }else if(mode == MeshMode_Greedy){
+        meshGreedy(blocks, halo, region, vertices, stats);
+    }else{
+        meshBinary(blocks, halo, region, vertices, stats);
+    }
+
+    stats.vertexCount = (int)vertices.size();
+    stats.meshTimeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    return vertices;
+}
+
+const char *ChunkMesher::getModeName(MeshMode mode)
+{
+    switch(mode){
+        case MeshMode_Naive: return "Naive";
+        case MeshMode_Culled: return "Culled";
+        case MeshMode_Greedy: return "Greedy";
+        case MeshMode_Binary: return "Binary";
+    }
+    return "";
+}
+
+void ChunkMesher::meshNaive(const ChunkStorage &blocks, const ChunkHalo &halo, const MeshRegion &region, std::vector<PackedVertex> &vertices, MeshStats &stats)
+{
+    BlockId scratch[CHUNK_SIZE];
+    for(int x = region.min[0]; x < region.max[0]; x++){
+        for(int z = region.min[2]; z < region.max[2]; z++){
+            const BlockId *column = blocks.column(x, z, scratch);
+            for(int y = region.min[1]; y < region.max[1]; y++){
+                if(column[y] == BlockId_Air) continue;
+                if(isHiddenBlock(blocks, halo, x, y, z)) continue;
+                createCube(vertices, x, y, z, toBlockType(column[y]));
+                stats.visibleBlocks++;
+                stats.faceCount += FACE_COUNT;
+            }
+        }
+    }
+    stats.naiveVertexCount = stats.visibleBlocks * FACE_COUNT * VERTICES_PER_FACE;
+}
+
+//Emits a face only when the block next to it is air. Blocks beside the chunk come from the halo, above and below are air.
+void ChunkMesher::meshCulled(const ChunkStorage &blocks, const ChunkHalo &halo, const MeshRegion &region, std::vector<PackedVertex> &vertices, MeshStats &stats)
+{
+    //The block's own column and its 4 horizontal neighbour columns, nullptr outside the chunk
+    BlockId scratch[5][CHUNK_SIZE];
+    for(int x = region.min[0]; x < region.max[0]; x++){
+        for(int z = region.min[2]; z < region.max[2]; z++){
+            const BlockId *column = blocks.column(x, z, scratch[0]);
+            const BlockId *neighbours[4] = {
+                z > 0 ? blocks.column(x, z - 1, scratch[1]) : nullptr,
+                z < CHUNK_SIZE - 1 ? blocks.column(x, z + 1, scratch[2]) : nullptr,
+                x > 0 ? blocks.column(x - 1, z, scratch[3]) : nullptr,
+                x < CHUNK_SIZE - 1 ? blocks.column(x + 1, z, scratch[4]) : nullptr,
+            };
+
+            for(int y = region.min[1]; y < region.max[1]; y++){
+                if(column[y] == BlockId_Air) continue;
+
+                bool exposed[FACE_COUNT];
+                exposed[0] = neighbours[0] ? neighbours[0][y] == BlockId_Air : !halo.isSolid(ChunkSide_NegZ, x, y);
+                exposed[1] = neighbours[1] ? neighbours[1][y] == BlockId_Air : !halo.isSolid(ChunkSide_PosZ, x, y);
+                exposed[2] = neighbours[2] ? neighbours[2][y] == BlockId_Air : !halo.isSolid(ChunkSide_NegX, z, y);
+                exposed[3] = neighbours[3] ? neighbours[3][y] == BlockId_Air : !halo.isSolid(ChunkSide_PosX, z, y);
+                exposed[4] = y == 0 || column[y - 1] == BlockId_Air;
+                exposed[5] = y == CHUNK_SIZE - 1 || column[y + 1] == BlockId_Air;
+
+                BlockType blockType = toBlockType(column[y]);
+                bool visible = false;
+                for(int face = 0; face < FACE_COUNT; face++){
+                    if(!exposed[face]) continue;
+                    createFace(vertices, face, x, y, z, blockType);
+                    stats.faceCount++;
+                    visible = true;
+                }
+                if(visible) stats.visibleBlocks++;
+            }
+        }
+    }
+    stats.naiveVertexCount = stats.visibleBlocks * FACE_COUNT * VERTICES_PER_FACE;
+}
+
+//Sweeps a plane through the region for each face direction. Every slice gets a 2D mask of the exposed
+//faces' block ids, which is then covered with the largest same-id rectangles, scanning row by row.
+//Quads never cross the region, so a region re-mesh gives the same quads as meshing the region in a full chunk.
+void ChunkMesher::meshGreedy(const ChunkStorage &blocks, const ChunkHalo &halo, const MeshRegion &region, std::vector<PackedVertex> &vertices, MeshStats &stats)
+{
+    //Decode the region plus a one column border once, so the sweeps along x and z don't go through the storage mode per block
+    std::vector<BlockId> ids(ChunkStorage::CHUNK_VOLUME);
+    BlockId scratch[CHUNK_SIZE];
+    int minX = std::max(region.min[0] - 1, 0), maxX = std::min(region.max[0] + 1, CHUNK_SIZE);
+    int minZ = std::max(region.min[2] - 1, 0), maxZ = std::min(region.max[2] + 1, CHUNK_SIZE);
+    for(int x = minX; x < maxX; x++){
+        for(int z = minZ; z < maxZ; z++){
+            std::memcpy(&ids[ChunkStorage::index(x, 0, z)], blocks.column(x, z, scratch), CHUNK_SIZE);
+        }
+    }
+    auto getId = [&ids](const int p[3]) { return ids[ChunkStorage::index(p[0], p[1], p[2])]; };
+
+    //Whether the face of block p towards q is exposed, q may be outside the chunk
+    auto isExposed = [&](const int q[3], int face) {
+        if(q[1] < 0 || q[1] >= CHUNK_SIZE) return true;
+        if(q[0] < 0 || q[0] >= CHUNK_SIZE) return !halo.isSolid(face, q[2], q[1]);
+        if(q[2] < 0 || q[2] >= CHUNK_SIZE) return !halo.isSolid(face, q[0], q[1]);
+        return getId(q) == BlockId_Air;
+    };
+
+    //Visible blocks are counted the same way the culled mesher counts them
+    std::vector<bool> visible(ChunkStorage::CHUNK_VOLUME, false);
+
+    BlockId mask[CHUNK_SIZE * CHUNK_SIZE];
+    for(int face = 0; face < FACE_COUNT; face++){
+        int axis = getFaceAxis(face);
+        int u = (axis + 1) % 3;
+        int v = (axis + 2) % 3;
+        int step = isPositiveFace(face) ? 1 : -1;
+        int width = region.max[u] - region.min[u];
+        int height = region.max[v] - region.min[v];
+
+        for(int d = region.min[axis]; d < region.max[axis]; d++){
+            //Build the mask of exposed faces in this slice
+            int p[3], q[3];
+            p[axis] = d;
+            q[axis] = d + step;
+            bool empty = true;
+            for(int j = 0; j < height; j++){
+                for(int i = 0; i < width; i++){
+                    p[u] = q[u] = region.min[u] + i;
+                    p[v] = q[v] = region.min[v] + j;
+                    BlockId id = getId(p);
+                    bool exposed = id != BlockId_Air && isExposed(q, face);
+                    mask[j * width + i] = exposed ? id : BlockId_Air;
+                    if(exposed){
+                        visible[ChunkStorage::index(p[0], p[1], p[2])] = true;
+                        empty = false;
+                    }
+                }
+            }
+            if(empty) continue;
+
+            //Cover the mask with rectangles
+            for(int j = 0; j < height; j++){
+                for(int i = 0; i < width;){
+                    BlockId id = mask[j * width + i];
+                    if(id == BlockId_Air){
+                        i++;
+                        continue;
+                    }
+
+                    int quadWidth = 1;
+                    while(i + quadWidth < width && mask[j * width + i + quadWidth] == id) quadWidth++;
+
+                    int quadHeight = 1;
+                    for(; j + quadHeight < height; quadHeight++){
+                        const BlockId *row = &mask[(j + quadHeight) * width + i];
+                        int k = 0;
+                        while(k < quadWidth && row[k] == id) k++;
+                        if(k < quadWidth) break;
+                    }
+
+                    int corner[3];
+                    corner[axis] = isPositiveFace(face) ? d + 1 : d;
+                    corner[u] = region.min[u] + i;
+                    corner[v] = region.min[v] + j;
+                    createQuad(vertices, face, corner, u, quadWidth, v, quadHeight, toBlockType(id));
+                    stats.faceCount++;
+
+                    for(int h = 0; h < quadHeight; h++){
+                        std::memset(&mask[(j + h) * width + i], BlockId_Air, quadWidth);
+                    }
+                    i += quadWidth;
+                }
+            }
+        }
+    }
+
+    for(int i = 0; i < ChunkStorage::CHUNK_VOLUME; i++){
+        if(visible[i]) stats.visibleBlocks++;
+    }
+    stats.naiveVertexCount = stats.visibleBlocks * FACE_COUNT * VERTICES_PER_FACE;
+}
+
+//Keeps one 32 bit occupancy mask per (x, z) column, bit y set for solid blocks. Exposed faces of a
+//whole column come from shifting the mask (up/down) or and-not'ing it with a neighbour column.
+void ChunkMesher::meshBinary(const ChunkStorage &blocks, const ChunkHalo &halo, const MeshRegion &region, std::vector<PackedVertex> &vertices, MeshStats &stats)
+{
+    static_assert(CHUNK_SIZE == 32, "column masks are 32 bits");
+
+    //Occupancy of the region's columns plus a one column border
+    uint32_t occupancy[CHUNK_SIZE][CHUNK_SIZE];
+    int minX = std::max(region.min[0] - 1, 0), maxX = std::min(region.max[0] + 1, CHUNK_SIZE);
+    int minZ = std::max(region.min[2] - 1, 0), maxZ = std::min(region.max[2] + 1, CHUNK_SIZE);
+    for(int x = minX; x < maxX; x++){
+        for(int z = minZ; z < maxZ; z++){
+            occupancy[x][z] = blocks.columnMask(x, z);
+        }
+    }
+
+    //Bits of the region's y range
+    int heightBits = region.max[1] - region.min[1];
+    uint32_t regionMask = (heightBits >= 32 ? 0xffffffffu : (1u << heightBits) - 1) << region.min[1];
+
+    //Face masks per column, in face order -z, +z, -x, +x, -y, +y. Beside the chunk comes from the halo.
+    uint32_t faceMasks[CHUNK_SIZE][CHUNK_SIZE][FACE_COUNT];
+    int faceCount = 0;
+    for(int x = region.min[0]; x < region.max[0]; x++){
+        for(int z = region.min[2]; z < region.max[2]; z++){
+            uint32_t mask = occupancy[x][z];
+            uint32_t *faces = faceMasks[x][z];
+            faces[0] = mask & ~(z > 0 ? occupancy[x][z - 1] : halo.border[ChunkSide_NegZ][x]);
+            faces[1] = mask & ~(z < CHUNK_SIZE - 1 ? occupancy[x][z + 1] : halo.border[ChunkSide_PosZ][x]);
+            faces[2] = mask & ~(x > 0 ? occupancy[x - 1][z] : halo.border[ChunkSide_NegX][z]);
+            faces[3] = mask & ~(x < CHUNK_SIZE - 1 ? occupancy[x + 1][z] : halo.border[ChunkSide_PosX][z]);
+            faces[4] = mask & ~(mask << 1);
+            faces[5] = mask & ~(mask >> 1);
+
+            uint32_t visible = 0;
+            for(int face = 0; face < FACE_COUNT; face++){
+                faces[face] &= regionMask;
+                faceCount += countBits(faces[face]);
+                visible |= faces[face];
+            }
+            stats.visibleBlocks += countBits(visible);
+        }
+    }
+
+    BlockId scratch[CHUNK_SIZE];
+    vertices.reserve(faceCount * VERTICES_PER_FACE);
+    for(int x = region.min[0]; x < region.max[0]; x++){
+        for(int z = region.min[2]; z < region.max[2]; z++){
+            const BlockId *column = nullptr;
+            for(int face = 0; face < FACE_COUNT; face++){
+                uint32_t mask = faceMasks[x][z][face];
+                if(mask && !column) column = blocks.column(x, z, scratch);
+                while(mask){
+                    int y = countTrailingZeros(mask);
+                    mask &= mask - 1;
+                    createFace(vertices, face, x, y, z, toBlockType(column[y]));
+                }
+            }
+        }
+    }
+
+    stats.faceCount = faceCount;
+    stats.naiveVertexCount = stats.visibleBlocks * FACE_COUNT * VERTICES_PER_FACE;
+}
+
+bool ChunkMesher::isHiddenBlock(const ChunkStorage &blocks, const ChunkHalo &halo, int x, int y, int z)
+{
+  int hiddenCount = 0;
+  if(x > 0 ? blocks.isActive(x-1,y,z) : halo.isSolid(ChunkSide_NegX,z,y)) hiddenCount++;
+  if(x < CHUNK_SIZE - 1 ? blocks.isActive(x+1,y,z) : halo.isSolid(ChunkSide_PosX,z,y)) hiddenCount++;
+
+  if(y > 0 && blocks.isActive(x,y-1,z)) hiddenCount++;
+  if(y < CHUNK_SIZE - 1 && blocks.isActive(x,y+1,z)) hiddenCount++;
+
+  if(z > 0 ? blocks.isActive(x,y,z-1) : halo.isSolid(ChunkSide_NegZ,x,y)) hiddenCount++;
+  if(z < CHUNK_SIZE - 1 ? blocks.isActive(x,y,z+1) : halo.isSolid(ChunkSide_PosZ,x,y)) hiddenCount++;
+
+  return (hiddenCount == 6);
+}
+
+PackedVertex ChunkMesher::packVertex(int x, int y, int z, int face, int ao, BlockType blockType)
+{
+    PackedVertex position = x | y << 6 | z << 12; //18 bits
+    PackedVertex material = toBlockId(blockType); //8 bits
+
+    return position | (PackedVertex)face << 18 | (PackedVertex)ao << 21 | material << 23;
+}
+
+//Packed position offsets of each face's corners from the block's (x, y, z) corner
+struct FaceCornerOffsets {
+    int offsets[ChunkMesher::FACE_COUNT][ChunkMesher::VERTICES_PER_FACE];
+};
+
+static FaceCornerOffsets buildFaceCornerOffsets()
+{
+    static const int CUBE_VERTICES_PER_FACE = 6;
+    static const int quadCorners[ChunkMesher::VERTICES_PER_FACE] = {0, 1, 2, 4};
+    FaceCornerOffsets table;
+    for(int face = 0; face < ChunkMesher::FACE_COUNT; face++){
+        for(int i = 0; i < ChunkMesher::VERTICES_PER_FACE; i++){
+            const float *corner = &cube[(face * CUBE_VERTICES_PER_FACE + quadCorners[i]) * 6];
+            int px = (int)(corner[0] + 0.5f); // [-0.5, 0.5] + 0.5 = [0,1]
+            int py = (int)(corner[1] + 0.5f);
+            int pz = (int)(corner[2] + 0.5f);
+            table.offsets[face][i] = px | py << 6 | pz << 12;
+        }
+    }
+    return table;
+}
+
+//Built on first use: static local initialization is thread safe, so meshing may run on several threads
+static const int (&getFaceCornerOffsets())[ChunkMesher::FACE_COUNT][ChunkMesher::VERTICES_PER_FACE]
+{
+    static const FaceCornerOffsets table = buildFaceCornerOffsets();
+    return table.offsets;
+}
+
+void ChunkMesher::createFace(std::vector<PackedVertex> &vertices, int face, int x, int y, int z, BlockType blockType)
+{
+    //Corner offsets are 0 or 1 per axis, so adding them to the packed block corner never carries
+    const int *offsets = getFaceCornerOffsets()[face];
+    PackedVertex vertex = packVertex(x, y, z, face, AO_NONE, blockType);
+    for(int i = 0; i < VERTICES_PER_FACE; i++){
+        vertices.push_back(vertex + offsets[i]);
+    }
+}
+
+void ChunkMesher::createQuad(std::vector<PackedVertex> &vertices, int face, const int corner[3], int u, int du, int v, int dv, BlockType blockType)
+{
+    //Corners in order: origin, +u, +u+v, +v, matching the quad index buffer of VertexArray
+    int corners[4][3];
+    for(int c = 0; c < 4; c++){
+        corners[c][0] = corner[0];
+        corners[c][1] = corner[1];
+        corners[c][2] = corner[2];
+    }
+    corners[1][u] += du;
+    corners[2][u] += du;
+    corners[2][v] += dv;
+    corners[3][v] += dv;
+
+    for(int i = 0; i < VERTICES_PER_FACE; i++){
+        const int *p = corners[i];
+        vertices.push_back(packVertex(p[0], p[1], p[2], face, AO_NONE, blockType));
+    }
+}
+
+void ChunkMesher::createCube(std::vector<PackedVertex> &vertices, int x, int y, int z, BlockType blockType)
+{
+    for(int face = 0; face < FACE_COUNT; face++){
+        createFace(vertices, face, x, y, z, blockType);
+    }
+}
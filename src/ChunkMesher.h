@@ -0,0 +1,110 @@
+#ifndef __CHUNKMESHER_H__
+#define __CHUNKMESHER_H__
+
+#include "ChunkStorage.h"
+#include <vector>
+
+enum MeshMode {
+    MeshMode_Naive,  // all 6 faces of every block that is not fully enclosed
+    MeshMode_Culled, // only the faces of a block that touch air
+    MeshMode_Greedy, // culled faces merged into maximal rectangles of the same block type
+    MeshMode_Binary, // same faces as MeshMode_Culled, found 32 blocks at a time with column bitmasks
+};
+
+//Horizontal sides of a chunk, in the same order as the first 4 mesher faces
+enum ChunkSide {
+    ChunkSide_NegZ,
+    ChunkSide_PosZ,
+    ChunkSide_NegX,
+    ChunkSide_PosX,
+    ChunkSide_Count,
+};
+
+//Read only copy of the neighbouring chunks' border columns, so faces on the chunk border can be culled.
+//border[side][i] is the occupancy mask (bit y set if solid) of the neighbour column touching the chunk
+//at x = i for the z sides and z = i for the x sides. Sides without a loaded neighbour are all air.
+struct ChunkHalo {
+    uint32_t border[ChunkSide_Count][ChunkStorage::CHUNK_SIZE] = {};
+
+    bool isSolid(int side, int i, int y) const { return (border[side][i] >> y) & 1; }
+};
+
+//Packed world vertex, 32 bits read by the shader as an unsigned integer attribute:
+//position(18 bits, 6 per axis) | face(3 bits) | ao(2 bits) | material(8 bits) | unused(1 bit)
+//Face is the index in face order -z, +z, -x, +x, -y, +y, material is the BlockId of the block.
+typedef uint32_t PackedVertex;
+
+//Per chunk mesh statistics
+struct MeshStats {
+    int visibleBlocks = 0;    // blocks with at least one exposed face
+    int faceCount = 0;        // faces emitted
+    int vertexCount = 0;      // vertices emitted
+    int naiveVertexCount = 0; // vertices MeshMode_Naive would emit for the same blocks
+    double meshTimeMs = 0.0;
+
+    MeshStats &operator+=(const MeshStats &other) {
+        visibleBlocks += other.visibleBlocks;
+        faceCount += other.faceCount;
+        vertexCount += other.vertexCount;
+        naiveVertexCount += other.naiveVertexCount;
+        meshTimeMs += other.meshTimeMs;
+        return *this;
+    }
+};
+
+//Box of blocks [min, max) to mesh, per axis x, y, z. Faces of blocks inside the box are emitted,
+//blocks outside it are only looked at for culling.
+struct MeshRegion {
+    int min[3];
+    int max[3];
+};
+
+//Turns chunk voxel data into packed vertices for the world shader.
+//Every face is a quad of 4 vertices, drawn with VertexArray's shared quad index buffer.
+//Positions are corners on the [0, 32] block lattice, so a greedy quad spanning several blocks
+//is encoded by its corner positions alone and needs no extra size bits.
+class ChunkMesher {
+public:
+    static const int CHUNK_SIZE = ChunkStorage::CHUNK_SIZE;
+    static const int FACE_COUNT = 6;
+    static const int VERTICES_PER_FACE = 4; // quads, drawn with a shared index buffer
+    static const int INDICES_PER_FACE = 6;
+    static const int AO_NONE = 3; // ambient occlusion level of an unoccluded corner, 0 is fully occluded
+    //Most faces a chunk mesh can have: 6 per block. The naive mesher only skips fully hidden blocks, so a
+    //chunk with one air block in 7 already gets 6 faces for almost every other block.
+    static const int MAX_FACES = ChunkStorage::CHUNK_VOLUME * FACE_COUNT;
+
+    //Chunks are split into REGION_COUNT cubes of REGION_SIZE blocks that can be re-meshed on their own
+    static const int REGION_SIZE = 16;
+    static const int REGIONS_PER_AXIS = CHUNK_SIZE / REGION_SIZE;
+    static const int REGION_COUNT = REGIONS_PER_AXIS * REGIONS_PER_AXIS * REGIONS_PER_AXIS;
+    static const uint32_t ALL_REGIONS = (1u << REGION_COUNT) - 1;
+
+    static MeshRegion getChunkRegion();
+    static MeshRegion getRegion(int region);
+    //Region containing block (x, y, z)
+    static int getRegionIndex(int x, int y, int z);
+
+    static std::vector<PackedVertex> mesh(const ChunkStorage &blocks, const ChunkHalo &halo, MeshMode mode, MeshStats &stats);
+    static std::vector<PackedVertex> mesh(const ChunkStorage &blocks, const ChunkHalo &halo, MeshMode mode, const MeshRegion &region, MeshStats &stats);
+    static const char *getModeName(MeshMode mode);
+
+private:
+    static void meshNaive(const ChunkStorage &blocks, const ChunkHalo &halo, const MeshRegion &region, std::vector<PackedVertex> &vertices, MeshStats &stats);
+    static void meshCulled(const ChunkStorage &blocks, const ChunkHalo &halo, const MeshRegion &region, std::vector<PackedVertex> &vertices, MeshStats &stats);
+    static void meshGreedy(const ChunkStorage &blocks, const ChunkHalo &halo, const MeshRegion &region, std::vector<PackedVertex> &vertices, MeshStats &stats);
+    static void meshBinary(const ChunkStorage &blocks, const ChunkHalo &halo, const MeshRegion &region, std::vector<PackedVertex> &vertices, MeshStats &stats);
+
+    static bool isHiddenBlock(const ChunkStorage &blocks, const ChunkHalo &halo, int x, int y, int z);
+
+    static PackedVertex packVertex(int x, int y, int z, int face, int ao, BlockType blockType);
+
+    //Appends the 4 vertices of one face of the block at (x, y, z)
+    static void createFace(std::vector<PackedVertex> &vertices, int face, int x, int y, int z, BlockType blockType);
+    //Appends all 24 vertices of the block at (x, y, z)
+    static void createCube(std::vector<PackedVertex> &vertices, int x, int y, int z, BlockType blockType);
+    //Appends a quad of the given face with corner at (x, y, z), spanning du along axis u and dv along axis v
+    static void createQuad(std::vector<PackedVertex> &vertices, int face, const int corner[3], int u, int du, int v, int dv, BlockType blockType);
+};
+
+#endif // __CHUNKMESHER_H__
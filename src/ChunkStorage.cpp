@@ -0,0 +1,142 @@
+#include "ChunkStorage.h"
+#include <cstring>
+
+ChunkStorage::ChunkStorage(ChunkStorageMode storageMode) : mode(storageMode), bitsPerIndex(0), indicesPerWord(0)
+{
+    if(mode == ChunkStorageMode_Flat){
+        flat.reset(new FlatBlocks);
+    }
+    fill(BlockId_Air);
+}
+
+ChunkStorage::ChunkStorage(const ChunkStorage &other) : mode(other.mode), bitsPerIndex(0), indicesPerWord(0)
+{
+    *this = other;
+}
+
+ChunkStorage &ChunkStorage::operator=(const ChunkStorage &other)
+{
+    if(this == &other) return *this;
+
+    mode = other.mode;
+    if(mode == ChunkStorageMode_Flat){
+        if(!flat) flat.reset(new FlatBlocks);
+        std::memcpy(flat->ids, other.flat->ids, sizeof(FlatBlocks));
+    }else{
+        flat.reset();
+    }
+    palette = other.palette;
+    words = other.words;
+    bitsPerIndex = other.bitsPerIndex;
+    indicesPerWord = other.indicesPerWord;
+    return *this;
+}
+
+const BlockId *ChunkStorage::column(int x, int z, BlockId *scratch) const
+{
+    int start = index(x, 0, z);
+    if(mode == ChunkStorageMode_Flat) return &flat->ids[start];
+
+    if(bitsPerIndex == 0){
+        std::memset(scratch, palette[0], CHUNK_SIZE);
+        return scratch;
+    }
+
+    //Walk the packed indices of the column sequentially instead of dividing per block
+    uint64_t mask = (1ull << bitsPerIndex) - 1;
+    int wordIndex = start / indicesPerWord;
+    int shift = (start % indicesPerWord) * bitsPerIndex;
+    for(int y = 0; y < CHUNK_SIZE; y++){
+        scratch[y] = palette[(words[wordIndex] >> shift) & mask];
+        shift += bitsPerIndex;
+        if(shift + bitsPerIndex > 64){
+            wordIndex++;
+            shift = 0;
+        }
+    }
+    return scratch;
+}
+
+//Tests 8 ids at a time: the high bit of each byte of t is set for non-zero bytes,
+//then the multiply gathers those bits into the top byte (little endian byte order).
+uint32_t ChunkStorage::columnMask(int x, int z) const
+{
+    BlockId scratch[CHUNK_SIZE];
+    const BlockId *ids = column(x, z, scratch);
+
+    uint32_t mask = 0;
+    for(int word = 0; word < CHUNK_SIZE / 8; word++){
+        uint64_t packed;
+        std::memcpy(&packed, ids + word * 8, sizeof(packed));
+        uint64_t t = ((packed & 0x7f7f7f7f7f7f7f7full) + 0x7f7f7f7f7f7f7f7full) | packed;
+        t = (t >> 7) & 0x0101010101010101ull;
+        mask |= (uint32_t)((t * 0x0102040810204080ull) >> 56) << (word * 8);
+    }
+    return mask;
+}
+
+void ChunkStorage::fill(BlockId id)
+{
+    if(mode == ChunkStorageMode_Flat){
+        std::memset(flat->ids, id, sizeof(FlatBlocks));
+        return;
+    }
+
+    //A uniform chunk needs no index data at all
+    palette.assign(1, id);
+    words.clear();
+    words.shrink_to_fit();
+    bitsPerIndex = 0;
+    indicesPerWord = 0;
+}
+
+size_t ChunkStorage::getMemoryUsage() const
+{
+    if(mode == ChunkStorageMode_Flat) return sizeof(FlatBlocks);
+    return palette.capacity() * sizeof(BlockId) + words.capacity() * sizeof(uint64_t);
+}
+
+void ChunkStorage::setPacked(int i, BlockId id)
+{
+    uint64_t paletteIndex = getPaletteIndex(id);
+    if(bitsPerIndex == 0) return;
+
+    uint64_t &word = words[i / indicesPerWord];
+    int shift = (i % indicesPerWord) * bitsPerIndex;
+    uint64_t mask = ((1ull << bitsPerIndex) - 1) << shift;
+    word = (word & ~mask) | (paletteIndex << shift);
+}
+
+//Finds id in the palette, adding it and widening the packed indices if needed
+int ChunkStorage::getPaletteIndex(BlockId id)
+{
+    for(int p = 0; p < (int)palette.size(); p++){
+        if(palette[p] == id) return p;
+    }
+
+    palette.push_back(id);
+    int bits = bitsPerIndex;
+    while((1 << bits) < (int)palette.size()) bits++;
+    if(bits != bitsPerIndex) repack(bits);
+
+    return (int)palette.size() - 1;
+}
+
+void ChunkStorage::repack(int bits)
+{
+    int newIndicesPerWord = 64 / bits;
+    std::vector<uint64_t> newWords((CHUNK_VOLUME + newIndicesPerWord - 1) / newIndicesPerWord, 0);
+
+    //Going from 0 bits every block already has palette index 0
+    if(bitsPerIndex != 0){
+        uint64_t mask = (1ull << bitsPerIndex) - 1;
+        for(int i = 0; i < CHUNK_VOLUME; i++){
+            uint64_t paletteIndex = (words[i / indicesPerWord] >> ((i % indicesPerWord) * bitsPerIndex)) & mask;
+            newWords[i / newIndicesPerWord] |= paletteIndex << ((i % newIndicesPerWord) * bits);
+        }
+    }
+
+    words.swap(newWords);
+    bitsPerIndex = bits;
+    indicesPerWord = newIndicesPerWord;
+}
@@ -0,0 +1,86 @@
+#ifndef __CHUNKSTORAGE_H__
+#define __CHUNKSTORAGE_H__
+
+#include "Block.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+enum ChunkStorageMode {
+    ChunkStorageMode_Flat,    // 1 byte block id per block
+    ChunkStorageMode_Palette, // per chunk palette of block ids + bit packed palette indices
+};
+
+//Voxel data of one chunk. Blocks are indexed linearly as (x, z, y) so every (x, z) column is contiguous.
+//Flat mode keeps the ids in a single cache line aligned buffer.
+//Palette mode stores each block as an index into a small palette, packed into 64 bit words.
+//The index width grows from 0 bits (uniform chunk) one bit at a time as the palette grows.
+class ChunkStorage {
+public:
+    static const int CHUNK_SIZE = 32;
+    static const int CHUNK_AREA = CHUNK_SIZE * CHUNK_SIZE;
+    static const int CHUNK_VOLUME = CHUNK_SIZE * CHUNK_SIZE * CHUNK_SIZE;
+
+    ChunkStorage(ChunkStorageMode mode = ChunkStorageMode_Flat);
+    ChunkStorage(const ChunkStorage &other);
+    ChunkStorage &operator=(const ChunkStorage &other);
+
+    //Linear index of a block, y is the fastest moving axis
+    static int index(int x, int y, int z) { return (x * CHUNK_SIZE + z) * CHUNK_SIZE + y; }
+
+    BlockId get(int x, int y, int z) const {
+        if(mode == ChunkStorageMode_Flat) return flat->ids[index(x, y, z)];
+        return getPacked(index(x, y, z));
+    }
+    void set(int x, int y, int z, BlockId id) {
+        if(mode == ChunkStorageMode_Flat) flat->ids[index(x, y, z)] = id;
+        else setPacked(index(x, y, z), id);
+    }
+    bool isActive(int x, int y, int z) const { return get(x, y, z) != BlockId_Air; }
+
+    //Returns the CHUNK_SIZE block ids of column (x, z) ordered by y.
+    //Points straight into flat storage, palette storage decodes into scratch.
+    const BlockId *column(int x, int z, BlockId *scratch) const;
+
+    //Bit y set for every non-air block of column (x, z)
+    uint32_t columnMask(int x, int z) const;
+
+    //Sets every block to id
+    void fill(BlockId id);
+
+    ChunkStorageMode getMode() const { return mode; }
+    int getPaletteSize() const { return (int)palette.size(); }
+    int getBitsPerBlock() const { return mode == ChunkStorageMode_Flat ? 8 * sizeof(BlockId) : bitsPerIndex; }
+
+    //Bytes of heap memory used by the voxel data
+    size_t getMemoryUsage() const;
+
+private:
+    struct alignas(64) FlatBlocks {
+        BlockId ids[CHUNK_VOLUME];
+    };
+
+    ChunkStorageMode mode;
+
+    //Flat mode
+    std::unique_ptr<FlatBlocks> flat;
+
+    //Palette mode
+    std::vector<BlockId> palette;
+    std::vector<uint64_t> words;
+    int bitsPerIndex;
+    int indicesPerWord;
+
+    BlockId getPacked(int i) const {
+        if(bitsPerIndex == 0) return palette[0];
+        uint64_t word = words[i / indicesPerWord];
+        int shift = (i % indicesPerWord) * bitsPerIndex;
+        return palette[(word >> shift) & ((1ull << bitsPerIndex) - 1)];
+    }
+    void setPacked(int i, BlockId id);
+    int getPaletteIndex(BlockId id);
+    void repack(int bits);
+};
+
+#endif // __CHUNKSTORAGE_H__
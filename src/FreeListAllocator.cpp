@@ -0,0 +1,83 @@
+#include "FreeListAllocator.h"
+#include <cassert>
+#include <iterator>
+
+FreeListAllocator::FreeListAllocator(int capacity) : capacity(0), used(0), highWaterMark(0)
+{
+    grow(capacity);
+}
+
+int FreeListAllocator::allocate(int size)
+{
+    if(size <= 0) return INVALID_OFFSET;
+
+    //Best fit keeps the large ranges whole for the chunks that need them
+    std::map<int, int>::iterator best = freeRanges.end();
+    for(std::map<int, int>::iterator range = freeRanges.begin(); range != freeRanges.end(); ++range){
+        if(range->second < size) continue;
+        if(best == freeRanges.end() || range->second < best->second) best = range;
+        if(range->second == size) break;
+    }
+    if(best == freeRanges.end()) return INVALID_OFFSET;
+
+    int offset = best->first;
+    int remaining = best->second - size;
+    freeRanges.erase(best);
+    if(remaining > 0) freeRanges[offset + size] = remaining;
+
+    allocated[offset] = size;
+    used += size;
+    if(offset + size > highWaterMark) highWaterMark = offset + size;
+    return offset;
+}
+
+void FreeListAllocator::free(int offset)
+{
+    std::map<int, int>::iterator range = allocated.find(offset);
+    assert(range != allocated.end());
+    int size = range->second;
+    allocated.erase(range);
+    used -= size;
+    addFreeRange(offset, size);
+}
+
+void FreeListAllocator::grow(int newCapacity)
+{
+    if(newCapacity <= capacity) return;
+    int oldCapacity = capacity;
+    capacity = newCapacity;
+    addFreeRange(oldCapacity, newCapacity - oldCapacity);
+}
+
+void FreeListAllocator::addFreeRange(int offset, int size)
+{
+    std::map<int, int>::iterator next = freeRanges.lower_bound(offset);
+    if(next != freeRanges.end() && offset + size == next->first){
+        size += next->second;
+        next = freeRanges.erase(next);
+    }
+    if(next != freeRanges.begin()){
+        std::map<int, int>::iterator previous = std::prev(next);
+        if(previous->first + previous->second == offset){
+            previous->second += size;
+            return;
+        }
+    }
+    freeRanges[offset] = size;
+}
+
+AllocatorStats FreeListAllocator::getStats() const
+{
+    AllocatorStats stats;
+    stats.capacity = capacity;
+    stats.used = used;
+    stats.allocations = (int)allocated.size();
+    stats.freeBlocks = (int)freeRanges.size();
+    stats.highWaterMark = highWaterMark;
+    for(const std::pair<const int, int> &range : freeRanges){
+        if(range.second > stats.largestFreeBlock) stats.largestFreeBlock = range.second;
+    }
+    int freeUnits = capacity - used;
+    if(freeUnits > 0) stats.fragmentation = 1.0f - (float)stats.largestFreeBlock / freeUnits;
+    return stats;
+}
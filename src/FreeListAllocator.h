@@ -0,0 +1,45 @@
+#ifndef __FREELISTALLOCATOR_H__
+#define __FREELISTALLOCATOR_H__
+
+#include <map>
+
+struct AllocatorStats {
+    int capacity = 0;         // units managed
+    int used = 0;             // units in live allocations
+    int allocations = 0;      // live allocations
+    int freeBlocks = 0;       // separate free ranges
+    int largestFreeBlock = 0;
+    int highWaterMark = 0;    // highest end offset ever allocated
+    //1 - largestFreeBlock / free units: 0 when all free space is one range, near 1 when it is scattered
+    float fragmentation = 0.0f;
+};
+
+//CPU side bookkeeping for carving one large buffer into ranges. Works in abstract units
+//(the world uses vertices), so it never touches GL itself.
+//Allocation is best fit over a free list ordered by offset; freed ranges merge with free neighbours.
+class FreeListAllocator {
+public:
+    static const int INVALID_OFFSET = -1;
+
+    FreeListAllocator(int capacity = 0);
+
+    //Offset of a new range of size units, INVALID_OFFSET when no free range is large enough
+    int allocate(int size);
+    void free(int offset);
+    //Adds units at the end, merging them with a free range that ends there
+    void grow(int newCapacity);
+
+    int getCapacity() const { return capacity; }
+    AllocatorStats getStats() const;
+
+private:
+    int capacity;
+    int used;
+    int highWaterMark;
+    std::map<int, int> freeRanges; // offset -> size
+    std::map<int, int> allocated;  // offset -> size
+
+    void addFreeRange(int offset, int size);
+};
+
+#endif // __FREELISTALLOCATOR_H__
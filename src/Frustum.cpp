@@ -0,0 +1,28 @@
+#include "Frustum.h"
+
+//Gribb and Hartmann: each clip plane is the last row of the matrix plus or minus one of the others
+Frustum::Frustum(const glm::mat4 &matrix)
+{
+    //glm is column major, matrix[column][row]
+    glm::vec4 rows[4];
+    for(int row = 0; row < 4; row++){
+        rows[row] = glm::vec4(matrix[0][row], matrix[1][row], matrix[2][row], matrix[3][row]);
+    }
+
+    planes[Plane_Left] = rows[3] + rows[0];
+    planes[Plane_Right] = rows[3] - rows[0];
+    planes[Plane_Bottom] = rows[3] + rows[1];
+    planes[Plane_Top] = rows[3] - rows[1];
+    planes[Plane_Near] = rows[3] + rows[2];
+    planes[Plane_Far] = rows[3] - rows[2];
+}
+
+bool Frustum::intersectsBox(const glm::vec3 &min, const glm::vec3 &max) const
+{
+    for(const glm::vec4 &plane : planes){
+        //Corner of the box furthest along the plane normal, if it is outside the whole box is
+        glm::vec3 corner(plane.x >= 0.0f ? max.x : min.x, plane.y >= 0.0f ? max.y : min.y, plane.z >= 0.0f ? max.z : min.z);
+        if(plane.x * corner.x + plane.y * corner.y + plane.z * corner.z + plane.w < 0.0f) return false;
+    }
+    return true;
+}
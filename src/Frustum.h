@@ -0,0 +1,33 @@
+#ifndef __FRUSTUM_H__
+#define __FRUSTUM_H__
+
+#include <glm/glm.hpp>
+
+//The 6 clip planes of a projection * view (* model) matrix, in the space that matrix transforms from.
+//Extracting from projection * view * model puts the planes in model space, so boxes can be tested
+//in their own units without transforming them.
+class Frustum {
+public:
+    enum Plane {
+        Plane_Left,
+        Plane_Right,
+        Plane_Bottom,
+        Plane_Top,
+        Plane_Near,
+        Plane_Far,
+        Plane_Count,
+    };
+
+    Frustum(const glm::mat4 &matrix);
+
+    //False only when the box is entirely outside one plane. Boxes near a frustum corner can pass
+    //while still being outside, which only costs a draw.
+    bool intersectsBox(const glm::vec3 &min, const glm::vec3 &max) const;
+
+    const glm::vec4 &getPlane(Plane plane) const { return planes[plane]; }
+
+private:
+    glm::vec4 planes[Plane_Count]; // xyz is the inward normal, a point p is inside when dot(xyz, p) + w >= 0
+};
+
+#endif // __FRUSTUM_H__
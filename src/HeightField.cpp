@@ -0,0 +1,51 @@
+#include "HeightField.h"
+#include <algorithm>
+#include <cstring>
+
+//Tile of grid coordinate v, rounding down for negative coordinates too
+static int getTileCoordinate(int v)
+{
+    return v >= 0 ? v / HeightField::TILE_SIZE : -((-v - 1) / HeightField::TILE_SIZE) - 1;
+}
+
+HeightField::HeightField(const TerrainGenerator &generator, HeightTileCache &tileCache)
+    : terrain(generator), cache(tileCache)
+{
+}
+
+void HeightField::getHeights(int x0, int z0, int width, int depth, float *heights)
+{
+    //Copy the window tile by tile
+    for(int tileZ = getTileCoordinate(z0); tileZ <= getTileCoordinate(z0 + depth - 1); tileZ++){
+        for(int tileX = getTileCoordinate(x0); tileX <= getTileCoordinate(x0 + width - 1); tileX++){
+            std::shared_ptr<Tile> tile = getTile(tileX, tileZ);
+            int tileX0 = tileX * TILE_SIZE, tileZ0 = tileZ * TILE_SIZE;
+            int xBegin = std::max(x0, tileX0), xEnd = std::min(x0 + width, tileX0 + TILE_SIZE);
+            int zBegin = std::max(z0, tileZ0), zEnd = std::min(z0 + depth, tileZ0 + TILE_SIZE);
+            for(int z = zBegin; z < zEnd; z++){
+                const float *source = &tile->heights[(z - tileZ0) * TILE_SIZE + (xBegin - tileX0)];
+                std::memcpy(heights + (z - z0) * width + (xBegin - x0), source, (xEnd - xBegin) * sizeof(float));
+            }
+        }
+    }
+}
+
+HeightFieldStats HeightField::getStats()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
+
+std::shared_ptr<HeightField::Tile> HeightField::getTile(int tileX, int tileZ)
+{
+    std::shared_ptr<Tile> tile = cache.getTile(terrain.getKey(), tileX, tileZ);
+    std::call_once(tile->generated, [&]{
+        tile->heights.resize(TILE_SIZE * TILE_SIZE);
+        terrain.getGridHeights(tileX * TILE_SIZE, tileZ * TILE_SIZE, TILE_SIZE, TILE_SIZE, tile->heights.data());
+
+        std::lock_guard<std::mutex> lock(mutex);
+        stats.tilesGenerated++;
+        stats.samplesGenerated += TILE_SIZE * TILE_SIZE;
+    });
+    return tile;
+}
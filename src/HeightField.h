@@ -0,0 +1,46 @@
+#ifndef __HEIGHTFIELD_H__
+#define __HEIGHTFIELD_H__
+
+#include "TerrainGenerator.h"
+#include "HeightTileCache.h"
+#include <memory>
+#include <mutex>
+
+struct HeightFieldStats {
+    int tilesGenerated = 0;
+    long long samplesGenerated = 0; // noise evaluations
+};
+
+//Terrain heights of the whole world on the integer world grid. Generated TILE_SIZE x TILE_SIZE points at a
+//time in one pass and kept in a HeightTileCache, so every chunk copies its window out of the same continuous
+//grid and chunks sharing a tile share its generation.
+//Safe to use from several threads: tiles are generated outside the lock, a thread needing a tile another
+//thread is generating waits for it.
+class HeightField {
+public:
+    static const int TILE_SIZE = 64; // 2 x 2 chunks
+
+    HeightField(const TerrainGenerator &terrain, HeightTileCache &cache);
+
+    HeightField(const HeightField &) = delete;
+    HeightField &operator=(const HeightField &) = delete;
+
+    //Heights in [-1, 1] of the width x depth grid points from (x0, z0), row by row along x, into heights
+    void getHeights(int x0, int z0, int width, int depth, float *heights);
+
+    HeightFieldStats getStats();
+    HeightTileCache &getCache() { return cache; }
+
+private:
+    typedef HeightTileCache::Tile Tile; // heights of TILE_SIZE rows along x
+
+    const TerrainGenerator &terrain;
+    HeightTileCache &cache;
+    std::mutex mutex;
+    HeightFieldStats stats;
+
+    //Tile (tileX, tileZ) covering x in [tileX * TILE_SIZE, (tileX + 1) * TILE_SIZE), generated if needed
+    std::shared_ptr<Tile> getTile(int tileX, int tileZ);
+};
+
+#endif // __HEIGHTFIELD_H__
@@ -0,0 +1,53 @@
+#include "HeightTileCache.h"
+
+size_t HeightTileCache::KeyHash::operator()(const Key &key) const
+{
+    uint64_t h = key.generator;
+    h = (h ^ (uint32_t)key.tileX) * 0x100000001b3ull;
+    h = (h ^ (uint32_t)key.tileZ) * 0x100000001b3ull;
+    return (size_t)(h ^ (h >> 32));
+}
+
+HeightTileCache::HeightTileCache(int tileCapacity)
+    : capacity(tileCapacity < 1 ? 1 : tileCapacity)
+{
+    stats.capacity = capacity;
+}
+
+std::shared_ptr<HeightTileCache::Tile> HeightTileCache::getTile(uint64_t generatorKey, int tileX, int tileZ)
+{
+    Key key{generatorKey, tileX, tileZ};
+    std::lock_guard<std::mutex> lock(mutex);
+
+    auto found = index.find(key);
+    if(found != index.end()){
+        stats.hits++;
+        entries.splice(entries.begin(), entries, found->second);
+        return found->second->tile;
+    }
+
+    stats.misses++;
+    entries.push_front(Entry{key, std::make_shared<Tile>()});
+    index[key] = entries.begin();
+    while((int)entries.size() > capacity){
+        index.erase(entries.back().key);
+        entries.pop_back();
+        stats.evictions++;
+    }
+    stats.tiles = (int)entries.size();
+    return entries.front().tile;
+}
+
+void HeightTileCache::clear()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    index.clear();
+    stats.tiles = 0;
+}
+
+HeightTileCacheStats HeightTileCache::getStats()
+{
+    std::lock_guard<std::mutex> lock(mutex);
+    return stats;
+}
@@ -0,0 +1,66 @@
+#ifndef __HEIGHTTILECACHE_H__
+#define __HEIGHTTILECACHE_H__
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <vector>
+
+struct HeightTileCacheStats {
+    int tiles = 0;       // tiles held
+    int capacity = 0;
+    long long hits = 0;  // requests for a tile already held
+    long long misses = 0; // requests that added a tile to generate
+    long long evictions = 0;
+};
+
+//Generated height tiles of any number of generators, keyed by (generator key, tile coordinates). Holds at
+//most capacity tiles and drops the least recently used one beyond that, so terrain that is generated again
+//(a reloaded chunk, a new World sharing the cache) reuses the heights instead of evaluating noise.
+//Safe to use from several threads. A tile is handed out before it is generated, see Tile.
+class HeightTileCache {
+public:
+    static const int DEFAULT_CAPACITY = 256; // 4 MB of 64 x 64 tiles
+
+    struct Tile {
+        //Whoever calls std::call_once on it first fills heights, the others wait for it
+        std::once_flag generated;
+        std::vector<float> heights;
+    };
+
+    explicit HeightTileCache(int capacity = DEFAULT_CAPACITY);
+
+    HeightTileCache(const HeightTileCache &) = delete;
+    HeightTileCache &operator=(const HeightTileCache &) = delete;
+
+    //The tile, added ungenerated on a miss. Evicted tiles stay valid for whoever still holds them.
+    std::shared_ptr<Tile> getTile(uint64_t generatorKey, int tileX, int tileZ);
+    void clear();
+
+    HeightTileCacheStats getStats();
+
+private:
+    struct Key {
+        uint64_t generator;
+        int tileX, tileZ;
+
+        bool operator==(const Key &other) const { return generator == other.generator && tileX == other.tileX && tileZ == other.tileZ; }
+    };
+    struct KeyHash {
+        size_t operator()(const Key &key) const;
+    };
+    struct Entry {
+        Key key;
+        std::shared_ptr<Tile> tile;
+    };
+
+    int capacity;
+    std::mutex mutex;
+    std::list<Entry> entries; // most recently used first
+    std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> index;
+    HeightTileCacheStats stats;
+};
+
+#endif // __HEIGHTTILECACHE_H__
@@ -0,0 +1,244 @@
+#include "OcclusionCuller.h"
+#include <algorithm>
+#include <cmath>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#define OCCLUSION_SSE2
+#include <emmintrin.h>
+#endif
+
+//Depth difference still counted as visible, so a box is never hidden by the occluder it contains
+static const float DEPTH_EPSILON = 1e-5f;
+
+//Corner k of a box has x from bit 0, y from bit 1 and z from bit 2.
+//Each face lists its corners counter clockwise seen from outside, so front faces project counter clockwise.
+static const int BOX_FACES[6][4] = {
+    {0, 4, 6, 2}, // -x
+    {1, 3, 7, 5}, // +x
+    {0, 1, 5, 4}, // -y
+    {2, 6, 7, 3}, // +y
+    {0, 2, 3, 1}, // -z
+    {4, 5, 7, 6}, // +z
+};
+
+//Edge function of a -> b as A * x + B * y + C, positive left of the edge
+struct EdgeFunction {
+    float a, b, c;
+
+    EdgeFunction() : a(0.0f), b(0.0f), c(0.0f) {}
+    EdgeFunction(float ax, float ay, float bx, float by) : a(ay - by), b(bx - ax), c(-(a * ax + b * ay)) {}
+};
+
+//Depth of a plane in screen space, z = x * zx + y * zy + zc
+struct DepthPlane {
+    float zx, zy, zc;
+};
+
+OcclusionCuller::OcclusionCuller() : matrix(1.0f), simdEnabled(hasSimd())
+{
+    std::fill(depth, depth + WIDTH * HEIGHT, 1.0f);
+}
+
+bool OcclusionCuller::hasSimd()
+{
+#ifdef OCCLUSION_SSE2
+    return true;
+#else
+    return false;
+#endif
+}
+
+void OcclusionCuller::begin(const glm::mat4 &viewMatrix)
+{
+    matrix = viewMatrix;
+    stats = OcclusionStats();
+    std::fill(depth, depth + WIDTH * HEIGHT, 1.0f);
+}
+
+bool OcclusionCuller::projectBox(const glm::vec3 &min, const glm::vec3 &max, ScreenVertex corners[8]) const
+{
+    for(int k = 0; k < 8; k++){
+        glm::vec4 corner((k & 1) ? max.x : min.x, (k & 2) ? max.y : min.y, (k & 4) ? max.z : min.z, 1.0f);
+        glm::vec4 clip = matrix * corner;
+        //In front of the near plane when z >= -w, which also keeps w positive
+        if(clip.z < -clip.w || clip.w <= 0.0f) return false;
+
+        float inverseW = 1.0f / clip.w;
+        corners[k].x = (clip.x * inverseW * 0.5f + 0.5f) * WIDTH;
+        corners[k].y = (clip.y * inverseW * 0.5f + 0.5f) * HEIGHT;
+        corners[k].z = clip.z * inverseW * 0.5f + 0.5f;
+    }
+    return true;
+}
+
+static float cross(const glm::vec2 &o, const glm::vec2 &a, const glm::vec2 &b)
+{
+    return (a.x - o.x) * (b.y - o.y) - (a.y - o.y) * (b.x - o.x);
+}
+
+//Writes only pixels entirely inside the box's silhouette, with the farthest depth the box's front surface
+//has over the pixel. Along a ray the front surface of a box is where it enters the last front face plane,
+//so that depth is the largest of the front face planes' depths.
+void OcclusionCuller::addOccluder(const glm::vec3 &min, const glm::vec3 &max)
+{
+    ScreenVertex corners[8];
+    if(!projectBox(min, max, corners)){
+        stats.skippedOccluders++;
+        return;
+    }
+    stats.occluders++;
+
+    DepthPlane planes[3];
+    int planeCount = 0;
+    for(const int *face : BOX_FACES){
+        const ScreenVertex &v0 = corners[face[0]], &v1 = corners[face[1]], &v2 = corners[face[2]], &v3 = corners[face[3]];
+        //Twice the projected area, the face is seen from the front when it stays counter clockwise
+        float area012 = (v1.x - v0.x) * (v2.y - v0.y) - (v1.y - v0.y) * (v2.x - v0.x);
+        float area023 = (v2.x - v0.x) * (v3.y - v0.y) - (v2.y - v0.y) * (v3.x - v0.x);
+        if(area012 + area023 <= 1e-6f || planeCount == 3) continue;
+
+        //The face is planar, so any of its triangles gives the plane. Use the larger for precision.
+        const ScreenVertex &a = area012 >= area023 ? v1 : v2;
+        const ScreenVertex &b = area012 >= area023 ? v2 : v3;
+        float area = std::max(area012, area023);
+        DepthPlane &plane = planes[planeCount++];
+        plane.zx = ((a.z - v0.z) * (b.y - v0.y) - (b.z - v0.z) * (a.y - v0.y)) / area;
+        plane.zy = ((a.x - v0.x) * (b.z - v0.z) - (b.x - v0.x) * (a.z - v0.z)) / area;
+        //Largest value over a pixel instead of at its centre
+        plane.zc = v0.z - plane.zx * v0.x - plane.zy * v0.y + 0.5f * (std::fabs(plane.zx) + std::fabs(plane.zy));
+    }
+    if(planeCount == 0) return;
+
+    //Silhouette: convex hull of the corners, counter clockwise (monotone chain)
+    glm::vec2 points[8];
+    for(int k = 0; k < 8; k++) points[k] = glm::vec2(corners[k].x, corners[k].y);
+    std::sort(points, points + 8, [](const glm::vec2 &l, const glm::vec2 &r){ return l.x < r.x || (l.x == r.x && l.y < r.y); });
+    glm::vec2 hull[16];
+    int hullSize = 0;
+    for(int k = 0; k < 8; k++){
+        while(hullSize >= 2 && cross(hull[hullSize - 2], hull[hullSize - 1], points[k]) <= 0.0f) hullSize--;
+        hull[hullSize++] = points[k];
+    }
+    for(int k = 6, lower = hullSize + 1; k >= 0; k--){
+        while(hullSize >= lower && cross(hull[hullSize - 2], hull[hullSize - 1], points[k]) <= 0.0f) hullSize--;
+        hull[hullSize++] = points[k];
+    }
+    hullSize--; // the last point repeats the first
+    if(hullSize < 3) return;
+
+    //Edges moved inwards by half a pixel's extent, so a pixel passes only if all of it is inside
+    EdgeFunction edges[8];
+    float minScreenX = hull[0].x, maxScreenX = hull[0].x, minScreenY = hull[0].y, maxScreenY = hull[0].y;
+    for(int e = 0; e < hullSize; e++){
+        const glm::vec2 &from = hull[e], &to = hull[(e + 1) % hullSize];
+        edges[e] = EdgeFunction(from.x, from.y, to.x, to.y);
+        edges[e].c -= 0.5f * (std::fabs(edges[e].a) + std::fabs(edges[e].b));
+        minScreenX = std::min(minScreenX, from.x);
+        maxScreenX = std::max(maxScreenX, from.x);
+        minScreenY = std::min(minScreenY, from.y);
+        maxScreenY = std::max(maxScreenY, from.y);
+    }
+    int minX = std::max(0, (int)std::floor(minScreenX));
+    int maxX = std::min(WIDTH - 1, (int)std::floor(maxScreenX));
+    int minY = std::max(0, (int)std::floor(minScreenY));
+    int maxY = std::min(HEIGHT - 1, (int)std::floor(maxScreenY));
+
+    //Starting on a multiple of 4 keeps the rows aligned, the extra pixels fail the edge tests.
+    //Both paths add the x term last, so they compute the same floats.
+    minX &= ~3;
+    for(int y = minY; y <= maxY; y++){
+        float py = y + 0.5f;
+        float *row = depth + y * WIDTH;
+#ifdef OCCLUSION_SSE2
+        if(simdEnabled){
+            __m128 zero = _mm_setzero_ps();
+            __m128 offsets = _mm_set_ps(3.5f, 2.5f, 1.5f, 0.5f);
+            for(int x = minX; x <= maxX; x += 4){
+                __m128 px = _mm_add_ps(_mm_set1_ps((float)x), offsets);
+                __m128 inside = _mm_castsi128_ps(_mm_set1_epi32(-1));
+                for(int e = 0; e < hullSize; e++){
+                    __m128 w = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(edges[e].a), px), _mm_set1_ps(edges[e].b * py + edges[e].c));
+                    inside = _mm_and_ps(inside, _mm_cmpge_ps(w, zero));
+                }
+                if(_mm_movemask_ps(inside) == 0) continue;
+
+                __m128 z = _mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes[0].zx), px), _mm_set1_ps(planes[0].zy * py + planes[0].zc));
+                for(int p = 1; p < planeCount; p++){
+                    z = _mm_max_ps(z, _mm_add_ps(_mm_mul_ps(_mm_set1_ps(planes[p].zx), px), _mm_set1_ps(planes[p].zy * py + planes[p].zc)));
+                }
+                __m128 old = _mm_load_ps(row + x);
+                __m128 closer = _mm_min_ps(old, z);
+                _mm_store_ps(row + x, _mm_or_ps(_mm_and_ps(inside, closer), _mm_andnot_ps(inside, old)));
+            }
+            continue;
+        }
+#endif
+        for(int x = minX; x <= maxX; x++){
+            float px = x + 0.5f;
+            bool inside = true;
+            for(int e = 0; e < hullSize && inside; e++){
+                inside = edges[e].a * px + (edges[e].b * py + edges[e].c) >= 0.0f;
+            }
+            if(!inside) continue;
+
+            float z = planes[0].zx * px + (planes[0].zy * py + planes[0].zc);
+            for(int p = 1; p < planeCount; p++){
+                z = std::max(z, planes[p].zx * px + (planes[p].zy * py + planes[p].zc));
+            }
+            row[x] = std::min(row[x], z);
+        }
+    }
+}
+
+bool OcclusionCuller::isVisible(const glm::vec3 &min, const glm::vec3 &max)
+{
+    stats.tests++;
+
+    //Boxes reaching behind the near plane cover too much of the screen to say
+    ScreenVertex corners[8];
+    if(!projectBox(min, max, corners)) return true;
+
+    float minScreenX = corners[0].x, maxScreenX = corners[0].x;
+    float minScreenY = corners[0].y, maxScreenY = corners[0].y;
+    float nearest = corners[0].z;
+    for(int k = 1; k < 8; k++){
+        minScreenX = std::min(minScreenX, corners[k].x);
+        maxScreenX = std::max(maxScreenX, corners[k].x);
+        minScreenY = std::min(minScreenY, corners[k].y);
+        maxScreenY = std::max(maxScreenY, corners[k].y);
+        nearest = std::min(nearest, corners[k].z);
+    }
+
+    //Every pixel the box's screen rectangle touches
+    int minX = std::max(0, (int)std::floor(minScreenX));
+    int maxX = std::min(WIDTH - 1, (int)std::floor(maxScreenX));
+    int minY = std::max(0, (int)std::floor(minScreenY));
+    int maxY = std::min(HEIGHT - 1, (int)std::floor(maxScreenY));
+    if(minX > maxX || minY > maxY){
+        stats.occluded++;
+        return false;
+    }
+
+    //Whole aligned groups of 4 pixels on both paths, WIDTH is a multiple of 4
+    float threshold = nearest - DEPTH_EPSILON;
+    minX &= ~3;
+    maxX |= 3;
+    for(int y = minY; y <= maxY; y++){
+        const float *row = depth + y * WIDTH;
+#ifdef OCCLUSION_SSE2
+        if(simdEnabled){
+            __m128 thresholds = _mm_set1_ps(threshold);
+            for(int x = minX; x <= maxX; x += 4){
+                if(_mm_movemask_ps(_mm_cmpge_ps(_mm_load_ps(row + x), thresholds))) return true;
+            }
+            continue;
+        }
+#endif
+        for(int x = minX; x <= maxX; x++){
+            if(row[x] >= threshold) return true;
+        }
+    }
+
+    stats.occluded++;
+    return false;
+}
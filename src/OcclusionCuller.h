@@ -0,0 +1,60 @@
+#ifndef __OCCLUSIONCULLER_H__
+#define __OCCLUSIONCULLER_H__
+
+#include <glm/glm.hpp>
+
+//Counters of the last begin() .. isVisible() pass
+struct OcclusionStats {
+    int occluders = 0;       // boxes rasterized
+    int skippedOccluders = 0; // boxes crossing the near plane, left out
+    int tests = 0;
+    int occluded = 0;
+};
+
+//Software occlusion culling on a small CPU depth buffer. Solid boxes (occluders) are rasterized into it,
+//then bounding boxes are tested against it: a box is hidden when every depth buffer pixel its screen
+//rectangle covers is closer than the box's nearest point.
+//Both steps err towards visible: occluders only write pixels they cover entirely, with the farthest depth
+//they have in the pixel, and boxes test every pixel they touch with their nearest depth.
+//Rows are processed 4 pixels at a time with SSE2 when available. The scalar path is always compiled in
+//and gives the same depths and answers, setSimdEnabled(false) switches to it for comparing the two.
+//Only depends on glm, so it runs without a GL context.
+class OcclusionCuller {
+public:
+    static const int WIDTH = 128;
+    static const int HEIGHT = 96;
+
+    OcclusionCuller();
+
+    //True when the SSE2 path is compiled in
+    static bool hasSimd();
+    void setSimdEnabled(bool enabled) { simdEnabled = enabled && hasSimd(); }
+    bool isSimdEnabled() const { return simdEnabled; }
+
+    //Clears the depth buffer for a new view. matrix takes the boxes' space to clip space.
+    void begin(const glm::mat4 &matrix);
+    //Rasterizes the box [min, max], which must be fully opaque. Boxes crossing the near plane are skipped.
+    void addOccluder(const glm::vec3 &min, const glm::vec3 &max);
+    //False when the box [min, max] is hidden behind the occluders added since begin()
+    bool isVisible(const glm::vec3 &min, const glm::vec3 &max);
+
+    const OcclusionStats &getStats() const { return stats; }
+    //WIDTH * HEIGHT depths in [0, 1] from the bottom row up, 1 where nothing was drawn
+    const float *getDepthBuffer() const { return depth; }
+
+private:
+    //Screen position in pixels and depth in [0, 1]
+    struct ScreenVertex {
+        float x, y, z;
+    };
+
+    alignas(16) float depth[WIDTH * HEIGHT];
+    glm::mat4 matrix;
+    OcclusionStats stats;
+    bool simdEnabled;
+
+    //Projects the 8 corners of the box, false if any is on or behind the near plane
+    bool projectBox(const glm::vec3 &min, const glm::vec3 &max, ScreenVertex corners[8]) const;
+};
+
+#endif // __OCCLUSIONCULLER_H__
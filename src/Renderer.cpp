@@ -5,7 +5,22 @@ void Renderer::draw(const VertexArray& va, Shader& shader) const
 {
     va.bind();
     shader.use();
-    glDrawArrays(GL_TRIANGLES, 0, va.getVBOSize() / va.getVertexSizeBytes()); //mode, starting index, count
+    int vertexCount = va.getVertexCount();
+    if(va.hasQuadIndices()){
+        glDrawElements(GL_TRIANGLES, vertexCount / 4 * 6, GL_UNSIGNED_INT, 0); //4 vertices and 6 indices per quad
+    }else{
+        glDrawArrays(GL_TRIANGLES, 0, vertexCount); //mode, starting index, count
+    }
 }
 
-
+void Renderer::drawRange(const VertexArray& va, Shader& shader, int firstVertex, int vertexCount) const
+{
+    va.bind();
+    shader.use();
+    if(va.hasQuadIndices()){
+        //The quad indices always start at 0, the base vertex moves them to the range
+        glDrawElementsBaseVertex(GL_TRIANGLES, vertexCount / 4 * 6, GL_UNSIGNED_INT, 0, firstVertex);
+    }else{
+        glDrawArrays(GL_TRIANGLES, firstVertex, vertexCount);
+    }
+}
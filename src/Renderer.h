@@ -7,5 +7,7 @@ class Renderer
 {
 public:
     virtual void draw(const VertexArray& va, Shader& shader) const;
+    //Draws vertexCount vertices of the bound VBO starting at firstVertex
+    virtual void drawRange(const VertexArray& va, Shader& shader, int firstVertex, int vertexCount) const;
 };
 #endif // __RENDERER_H__
\ No newline at end of file
@@ -8,6 +8,7 @@
 #include <glm/gtc/type_ptr.hpp>
 
 #include <string>
+#include <unordered_map>
 #include <fstream>
 #include <sstream>
 #include <iostream>
@@ -36,6 +37,15 @@ public:
     void setMat4(const std::string &name, glm::mat4 matrix) const;
     void setVec3(const std::string &name, glm::vec3 vec3) const;
     void setVec4(const std::string &name, glm::vec4 vec4) const;
+
+    //Location of uniform name, from the table built when the program is linked. A name the program does not
+    //use is reported once and gives -1, which the glUniform calls ignore.
+    int getUniformLocation(const std::string &name) const;
+    //Makes the uniform block name read from bindingPoint (see UniformBuffer)
+    void bindUniformBlock(const std::string &name, unsigned int bindingPoint) const;
+
+private:
+    mutable std::unordered_map<std::string, int> uniformLocations;
 };
   
 #endif
\ No newline at end of file
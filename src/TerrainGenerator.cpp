@@ -0,0 +1,214 @@
+#include "TerrainGenerator.h"
+#include <algorithm>
+#include <vector>
+
+const int TerrainGenerator::COARSE_SPACINGS[COARSE_SPACING_COUNT] = {8, 4, 2};
+
+//Grid coordinate v rounded down to a multiple of spacing, for negative coordinates too
+static int floorToMultiple(int v, int spacing)
+{
+    return (v >= 0 ? v / spacing : -((-v - 1) / spacing) - 1) * spacing;
+}
+
+//Adds lattice, interpolated bilinearly, to the width x depth points x0 + x * step, z0 + z * step inside it.
+//step divides lattice.spacing and x0 - lattice.x0. Each row is interpolated along z on the lattice, then
+//along x into a row of every step points, so the per point work is an add.
+void TerrainGenerator::addInterpolated(const Lattice &lattice, int x0, int z0, int step, int width, int depth, float *values)
+{
+    int ratio = lattice.spacing / step;
+    std::vector<float> latticeRow(lattice.width), row((lattice.width - 1) * ratio + 1), ramp(ratio);
+    for(int t = 0; t < ratio; t++){
+        ramp[t] = (float)t / ratio;
+    }
+    int rowOffset = (x0 - lattice.x0) / step;
+
+    for(int z = 0; z < depth; z++){
+        int offset = z0 + z * step - lattice.z0;
+        const float *near = &lattice.values[offset / lattice.spacing * lattice.width];
+        const float *far = near + (offset % lattice.spacing ? lattice.width : 0); // points on a lattice row need no next row, the last has none
+        float tz = (float)(offset % lattice.spacing) / lattice.spacing;
+        for(int i = 0; i < lattice.width; i++){
+            latticeRow[i] = near[i] + tz * (far[i] - near[i]);
+        }
+        for(int i = 0; i + 1 < lattice.width; i++){
+            float difference = latticeRow[i + 1] - latticeRow[i];
+            for(int t = 0; t < ratio; t++){
+                row[i * ratio + t] = latticeRow[i] + ramp[t] * difference;
+            }
+        }
+        row.back() = latticeRow.back();
+
+        float *destination = values + z * width;
+        for(int x = 0; x < width; x++){
+            destination[x] += row[rowOffset + x];
+        }
+    }
+}
+
+TerrainGenerator::TerrainGenerator(HeightSource heightSource, float coarseErrorBound)
+    : source(heightSource), coarseError(0.0f)
+{
+    heightModule.SetFrequency(0.01f);
+    batchNoise = BatchPerlin(heightModule);
+
+    //From the lowest octave up, each as coarse as the error left allows but no coarser than the one below,
+    //so octaves of equal spacing are consecutive. Higher octaves interpolate worse, the first that fits no
+    //spacing and every one above stay at full resolution.
+    octaveSpacings.assign(batchNoise.getOctaveCount(), 1);
+    int spacingIndex = 0;
+    for(int octave = 0; source == HeightSource_Batch && octave < batchNoise.getOctaveCount(); octave++){
+        while(spacingIndex < COARSE_SPACING_COUNT && coarseError + batchNoise.getInterpolationError(octave, (float)COARSE_SPACINGS[spacingIndex]) > coarseErrorBound){
+            spacingIndex++;
+        }
+        if(spacingIndex == COARSE_SPACING_COUNT) break;
+        octaveSpacings[octave] = COARSE_SPACINGS[spacingIndex];
+        coarseError += batchNoise.getInterpolationError(octave, (float)COARSE_SPACINGS[spacingIndex]);
+    }
+}
+
+uint64_t TerrainGenerator::getKey() const
+{
+    struct {
+        int source, seed, octaveCount, quality;
+        double frequency, lacunarity, persistence;
+    } parameters = {source, heightModule.GetSeed(), heightModule.GetOctaveCount(), heightModule.GetNoiseQuality(),
+                    heightModule.GetFrequency(), heightModule.GetLacunarity(), heightModule.GetPersistence()};
+
+    //FNV-1a over the parameters, which have no padding, then the spacings
+    const unsigned char *bytes = (const unsigned char *)&parameters;
+    uint64_t key = 0xcbf29ce484222325ull;
+    for(size_t b = 0; b < sizeof(parameters); b++){
+        key = (key ^ bytes[b]) * 0x100000001b3ull;
+    }
+    for(int spacing : octaveSpacings){
+        key = (key ^ (uint64_t)spacing) * 0x100000001b3ull;
+    }
+    return key;
+}
+
+void TerrainGenerator::getHeightMap(double x0, double z0, int size, utils::NoiseMap &heightMap, ThreadPool *pool) const
+{
+    if(source == HeightSource_Batch){
+        //The points NoiseMapBuilderPlane samples: the bounds split into size steps, added up one at a time
+        double delta = (double)(size - 1) / size;
+        std::vector<float> xs(size), zs(size);
+        double x = x0;
+        for(int k = 0; k < size; k++){
+            xs[k] = (float)x;
+            x += delta;
+        }
+
+        heightMap.SetSize(size, size);
+        double z = z0;
+        for(int row = 0; row < size; row++){
+            std::fill(zs.begin(), zs.end(), (float)z);
+            batchNoise.getValues(xs.data(), zs.data(), size, heightMap.GetSlabPtr(row));
+            z += delta;
+        }
+        return;
+    }
+
+    utils::NoiseMapBuilderPlane heightMapBuilder;
+    heightMapBuilder.SetSourceModule(heightModule);
+    heightMapBuilder.SetDestNoiseMap(heightMap);
+    heightMapBuilder.SetDestSize(size, size);
+    heightMapBuilder.SetBounds(x0, x0 + size - 1, z0, z0 + size - 1);
+    heightMapBuilder.SetThreadPool(pool);
+    heightMapBuilder.Build();
+}
+
+void TerrainGenerator::getGridHeights(int x0, int z0, int width, int depth, float *heights) const
+{
+    if(source == HeightSource_Batch){
+        //Octaves sampled at every point, above the coarse ones
+        int fineOctave = 0;
+        while(fineOctave < (int)octaveSpacings.size() && octaveSpacings[fineOctave] > 1){
+            fineOctave++;
+        }
+
+        std::vector<float> xs(width), zs(width);
+        for(int x = 0; x < width; x++){
+            xs[x] = (float)(x0 + x);
+        }
+        for(int z = 0; z < depth; z++){
+            std::fill(zs.begin(), zs.end(), (float)(z0 + z));
+            batchNoise.getValues(xs.data(), zs.data(), width, heights + z * width, fineOctave, (int)octaveSpacings.size());
+        }
+
+        //Each run of coarse octaves of one spacing, coarsest first. A run is added into the next finer lattice,
+        //which nests in it, so the grid is interpolated once whatever the number of runs.
+        Lattice coarse;
+        for(int first = 0; first < fineOctave;){
+            int end = first;
+            while(end < fineOctave && octaveSpacings[end] == octaveSpacings[first]){
+                end++;
+            }
+            Lattice lattice = getCoarseOctaves(x0, z0, width, depth, octaveSpacings[first], first, end);
+            if(first > 0){
+                addInterpolated(coarse, lattice.x0, lattice.z0, lattice.spacing, lattice.width, lattice.depth, lattice.values.data());
+            }
+            coarse = std::move(lattice);
+            first = end;
+        }
+        if(fineOctave > 0){
+            addInterpolated(coarse, x0, z0, 1, width, depth, heights);
+        }
+        return;
+    }
+
+    for(int z = 0; z < depth; z++){
+        for(int x = 0; x < width; x++){
+            heights[z * width + x] = (float)heightModule.GetValue(x0 + x, 0.0, z0 + z);
+        }
+    }
+}
+
+TerrainGenerator::Lattice TerrainGenerator::getCoarseOctaves(int x0, int z0, int width, int depth, int spacing, int firstOctave, int octaveEnd) const
+{
+    //Every multiple of spacing from the one at or below the region to the one past it, so a point gets the
+    //same value whatever region it is generated with
+    Lattice lattice;
+    lattice.spacing = spacing;
+    lattice.x0 = floorToMultiple(x0, spacing);
+    lattice.z0 = floorToMultiple(z0, spacing);
+    lattice.width = (floorToMultiple(x0 + width - 1, spacing) - lattice.x0) / spacing + 2;
+    lattice.depth = (floorToMultiple(z0 + depth - 1, spacing) - lattice.z0) / spacing + 2;
+    lattice.values.resize(lattice.width * lattice.depth);
+
+    std::vector<float> xs(lattice.width), zs(lattice.width);
+    for(int i = 0; i < lattice.width; i++){
+        xs[i] = (float)(lattice.x0 + i * spacing);
+    }
+    for(int j = 0; j < lattice.depth; j++){
+        std::fill(zs.begin(), zs.end(), (float)(lattice.z0 + j * spacing));
+        batchNoise.getValues(xs.data(), zs.data(), lattice.width, &lattice.values[j * lattice.width], firstOctave, octaveEnd);
+    }
+    return lattice;
+}
+
+void TerrainGenerator::writeDebugImage(double x0, double z0, int size, const std::string &filename, ThreadPool *pool) const
+{
+    utils::NoiseMap heightMap;
+    getHeightMap(x0, z0, size, heightMap, pool);
+
+    //Set up the image renderer of the height map
+    utils::Image image;
+    utils::RendererImage rendererImage;
+    rendererImage.SetSourceNoiseMap (heightMap);
+    rendererImage.SetDestImage (image);
+    rendererImage.ClearGradient ();
+    rendererImage.AddGradientPoint (-1.0000, utils ::Color (  0,   0, 128, 255)); // deeps
+    rendererImage.AddGradientPoint (-0.2500, utils::Color (  0,   0, 255, 255)); // shallow
+    rendererImage.AddGradientPoint ( 0.0000, utils::Color (  0, 128, 255, 255)); // shore
+    rendererImage.AddGradientPoint ( 0.0625, utils::Color (240, 240,  64, 255)); // sand
+    rendererImage.AddGradientPoint ( 0.1250, utils::Color ( 32, 160,   0, 255)); // grass
+    rendererImage.AddGradientPoint ( 0.3750, utils::Color (224, 224,   0, 255)); // dirt
+    rendererImage.AddGradientPoint ( 0.7500, utils::Color (128, 128, 128, 255)); // rock
+    rendererImage.AddGradientPoint ( 1.0000, utils::Color (255, 255, 255, 255)); // snow
+    rendererImage.Render ();
+
+    utils::WriterBMP writer;
+    writer.SetSourceImage (image);
+    writer.SetDestFilename (filename);
+    writer.WriteDestFile ();
+}
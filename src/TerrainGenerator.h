@@ -0,0 +1,73 @@
+#ifndef __TERRAINGENERATOR_H__
+#define __TERRAINGENERATOR_H__
+
+#include <noise/noise.h>
+#include "noiseutils.h"
+#include "BatchPerlin.h"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class ThreadPool;
+
+enum HeightSource {
+    HeightSource_Libnoise, // module::Perlin through NoiseMapBuilderPlane, one point at a time in double
+    HeightSource_Batch,    // the same noise from BatchPerlin, several points at once in float
+};
+
+//Height map source shared by every chunk of the world.
+//Holds only the noise parameters and octave spacings. Each request builds into its own NoiseMap, so the
+//generator can be used from several threads at once.
+class TerrainGenerator {
+public:
+    //Lattice spacings low octaves may be sampled at in getGridHeights, coarsest first
+    static const int COARSE_SPACING_COUNT = 3;
+    static const int COARSE_SPACINGS[COARSE_SPACING_COUNT];
+
+    //With the batch source and coarseErrorBound > 0, getGridHeights samples the lowest octaves on a coarse
+    //lattice and interpolates them, as coarsely as keeps the sum of their error estimates (see
+    //BatchPerlin::getInterpolationError) within coarseErrorBound. Heights are in [-1, 1], a block is 1/16.
+    //0 samples every octave at every point.
+    TerrainGenerator(HeightSource source = HeightSource_Batch, float coarseErrorBound = 0.0f);
+
+    HeightSource getHeightSource() const { return source; }
+    //Hash of the source, every noise parameter (seed included) and the octave spacings, equal for generators
+    //giving the same heights
+    uint64_t getKey() const;
+
+    //Lattice spacing getGridHeights samples octave at, 1 for every point
+    int getOctaveSpacing(int octave) const { return octaveSpacings[octave]; }
+    //Estimate of how far getGridHeights can be from sampling every octave at every point, the sum of the
+    //coarse octaves' error estimates. Measured, not guaranteed: the tests check it holds for these parameters.
+    float getCoarseError() const { return coarseError; }
+
+    //Fills heightMap with size x size noise values in [-1, 1] sampled at x in [x0, x0 + size - 1], z in [z0, z0 + size - 1].
+    //With the libnoise source rows are shared with pool when given, worth it for maps much larger than a chunk.
+    void getHeightMap(double x0, double z0, int size, utils::NoiseMap &heightMap, ThreadPool *pool = nullptr) const;
+
+    //Heights of the width x depth points of the integer grid from (x0, z0), row by row along x, into heights.
+    //The samples HeightField keeps, the same at a point whatever region it is generated with.
+    void getGridHeights(int x0, int z0, int width, int depth, float *heights) const;
+
+    //Opt-in debug output: renders the same area as a coloured BMP
+    void writeDebugImage(double x0, double z0, int size, const std::string &filename, ThreadPool *pool = nullptr) const;
+
+private:
+    HeightSource source;
+    module::Perlin heightModule;
+    BatchPerlin batchNoise; // copy of heightModule's parameters
+    std::vector<int> octaveSpacings; // per octave, never increasing
+    float coarseError;
+
+    //Values on the grid points that are multiples of spacing, width x depth of them from (x0, z0)
+    struct Lattice {
+        int x0, z0, width, depth, spacing;
+        std::vector<float> values;
+    };
+
+    //Octaves [firstOctave, octaveEnd) on the lattice of spacing around the grid region from (x0, z0)
+    Lattice getCoarseOctaves(int x0, int z0, int width, int depth, int spacing, int firstOctave, int octaveEnd) const;
+    static void addInterpolated(const Lattice &lattice, int x0, int z0, int step, int width, int depth, float *values);
+};
+
+#endif // __TERRAINGENERATOR_H__
@@ -0,0 +1,64 @@
+#include "ThreadPool.h"
+
+ThreadPool::ThreadPool(int threadCount)
+{
+    if(threadCount <= 0){
+        threadCount = (int)std::thread::hardware_concurrency() - 1;
+        if(threadCount < 1) threadCount = 1;
+    }
+
+    for(int i = 0; i < threadCount; i++){
+        threads.emplace_back(&ThreadPool::workerLoop, this);
+    }
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    jobAvailable.notify_all();
+    for(std::thread &thread : threads){
+        thread.join();
+    }
+}
+
+void ThreadPool::submit(std::function<void()> job)
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        jobs.push_back(std::move(job));
+    }
+    jobAvailable.notify_one();
+}
+
+void ThreadPool::waitIdle()
+{
+    std::unique_lock<std::mutex> lock(mutex);
+    jobsDone.wait(lock, [this]{ return jobs.empty() && runningJobs == 0; });
+}
+
+void ThreadPool::workerLoop()
+{
+    while(true){
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            jobAvailable.wait(lock, [this]{ return stopping || !jobs.empty(); });
+            if(stopping && jobs.empty()) return;
+
+            job = std::move(jobs.front());
+            jobs.pop_front();
+            runningJobs++;
+        }
+
+        job();
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            runningJobs--;
+            if(jobs.empty() && runningJobs == 0) jobsDone.notify_all();
+        }
+    }
+}
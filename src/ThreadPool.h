@@ -0,0 +1,39 @@
+#ifndef __THREADPOOL_H__
+#define __THREADPOOL_H__
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//Fixed set of worker threads running queued jobs in submission order.
+//Jobs must not touch GL, only the main thread owns the context.
+class ThreadPool {
+public:
+    //threadCount 0 uses one thread per core, leaving one core for the main thread
+    ThreadPool(int threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool &) = delete;
+    ThreadPool &operator=(const ThreadPool &) = delete;
+
+    void submit(std::function<void()> job);
+    //Blocks until the queue is empty and no job is running
+    void waitIdle();
+    int getThreadCount() const { return (int)threads.size(); }
+
+private:
+    std::vector<std::thread> threads;
+    std::deque<std::function<void()>> jobs;
+    std::mutex mutex;
+    std::condition_variable jobAvailable;
+    std::condition_variable jobsDone;
+    int runningJobs = 0;
+    bool stopping = false;
+
+    void workerLoop();
+};
+
+#endif // __THREADPOOL_H__
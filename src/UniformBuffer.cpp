@@ -0,0 +1,38 @@
+#include "UniformBuffer.h"
+#include <cstring>
+
+UniformBuffer::UniformBuffer(GLuint point, size_t size, int slots)
+    : bindingPoint(point), blockSize(size), slotCount(slots)
+{
+    //Slots are bound with glBindBufferRange, whose offsets must be multiples of the alignment
+    GLint alignment = 1;
+    glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+    slotStride = (blockSize + alignment - 1) / alignment * alignment;
+    data.assign(slotStride * slotCount, 0);
+
+    glGenBuffers(1, &id);
+    glBindBuffer(GL_UNIFORM_BUFFER, id);
+    glBufferData(GL_UNIFORM_BUFFER, data.size(), nullptr, GL_DYNAMIC_DRAW);
+    bindSlot(0);
+}
+
+UniformBuffer::~UniformBuffer()
+{
+    glDeleteBuffers(1, &id);
+}
+
+void UniformBuffer::setSlot(int slot, const void *block)
+{
+    std::memcpy(data.data() + slot * slotStride, block, blockSize);
+}
+
+void UniformBuffer::upload()
+{
+    glBindBuffer(GL_UNIFORM_BUFFER, id);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, data.size(), data.data());
+}
+
+void UniformBuffer::bindSlot(int slot) const
+{
+    glBindBufferRange(GL_UNIFORM_BUFFER, bindingPoint, id, slot * slotStride, blockSize);
+}
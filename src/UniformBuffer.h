@@ -0,0 +1,49 @@
+#ifndef __UNIFORMBUFFER_H__
+#define __UNIFORMBUFFER_H__
+
+#include <glad/glad.h>
+#include <glm/glm.hpp>
+#include <cstddef>
+#include <vector>
+
+//The Frame uniform block of WorldShader.GLSL and WaterShader.GLSL, in std140 layout: per view values
+//every pass used to send itself. vec3s are padded to vec4s as std140 does.
+struct FrameUniforms {
+    glm::mat4 view;
+    glm::mat4 projection;
+    glm::vec4 cameraPosition; // xyz
+    glm::vec4 lightPosition;  // xyz
+    glm::vec4 lightColor;     // rgb
+};
+const GLuint FRAME_BINDING = 0;
+
+//Values of one std140 uniform block for several views (e.g. the camera and its reflection) in one buffer.
+//The CPU copies of all slots are uploaded together, then bindSlot points the block's binding point at one.
+//Shaders only need Shader::bindUniformBlock once to read it.
+class UniformBuffer {
+public:
+    UniformBuffer(GLuint bindingPoint, size_t blockSize, int slotCount = 1);
+    ~UniformBuffer();
+    UniformBuffer(const UniformBuffer &) = delete;
+    UniformBuffer &operator=(const UniformBuffer &) = delete;
+
+    //Copies blockSize bytes of data into slot, sent with the next upload
+    void setSlot(int slot, const void *data);
+    template <typename T>
+    void setSlot(int slot, const T &block) { setSlot(slot, (const void *)&block); }
+    //One glBufferSubData for every slot
+    void upload();
+    void bindSlot(int slot) const;
+
+    GLuint getBindingPoint() const { return bindingPoint; }
+
+private:
+    GLuint id = 0;
+    GLuint bindingPoint;
+    size_t blockSize;
+    size_t slotStride; // blockSize rounded up to GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT
+    int slotCount;
+    std::vector<unsigned char> data;
+};
+
+#endif // __UNIFORMBUFFER_H__
@@ -1,4 +1,5 @@
 #include "VertexArray.h"
+#include <stdexcept>
 
 
 VertexArray::VertexArray()
@@ -6,7 +7,8 @@ VertexArray::VertexArray()
     glGenVertexArrays(1, &VAO);
     glBindVertexArray(VAO);
     vf = VertexFormat_Default;
-
+    quadEBO = 0;
+    vertexSizeBytes = computeVertexSizeBytes(vf);
 }
 
 VertexArray::VertexArray(VertexFormat vertexformat)
@@ -14,46 +16,230 @@ VertexArray::VertexArray(VertexFormat vertexformat)
     glGenVertexArrays(1, &VAO);
     glBindVertexArray(VAO);
     vf = vertexformat;
-
+    quadEBO = 0;
+    vertexSizeBytes = computeVertexSizeBytes(vf);
 }
 
 void VertexArray::bind() const
 {
-    glBindVertexArray(VAO);
+    const VertexBuffer *vbo = VBOs.get(boundVBO);
+    glBindVertexArray(vbo ? vbo->vao : VAO);
 }
 
-int VertexArray::getVBOSize() const
+VBOHandle VertexBufferRegistry::add(const std::string &key)
 {
-    int size;
-    glGetBufferParameteriv(GL_ARRAY_BUFFER, GL_BUFFER_SIZE, &size);
+    std::map<std::string, VBOHandle>::iterator existing = keys.find(key);
+    if(existing != keys.end()) return existing->second;
 
-    return size;
+    VBOHandle handle;
+    if(!freeSlots.empty()){
+        handle.index = freeSlots.back();
+        freeSlots.pop_back();
+    }else{
+        handle.index = (uint32_t)slots.size();
+        slots.push_back(Slot());
+    }
+    Slot &slot = slots[handle.index];
+    slot.buffer = VertexBuffer();
+    slot.key = key;
+    slot.live = true;
+    handle.generation = slot.generation;
+    keys[key] = handle;
+    return handle;
 }
 
+void VertexBufferRegistry::remove(VBOHandle handle)
+{
+    if(!get(handle)) return;
+    Slot &slot = slots[handle.index];
+    keys.erase(slot.key);
+    slot.key.clear();
+    slot.live = false;
+    //Skip 0 on wrap around, it marks handles that never referred to anything
+    if(++slot.generation == 0) slot.generation = 1;
+    freeSlots.push_back(handle.index);
+}
 
-//Creates a vertex buffer object for vertices
-void VertexArray::createVBO(std::string key, std::vector<float> vertices){
+VBOHandle VertexBufferRegistry::find(const std::string &key) const
+{
+    std::map<std::string, VBOHandle>::const_iterator existing = keys.find(key);
+    return existing != keys.end() ? existing->second : VBOHandle();
+}
+
+VertexBuffer &VertexBufferRegistry::at(VBOHandle handle)
+{
+    VertexBuffer *buffer = get(handle);
+    if(!buffer) throw std::out_of_range("VertexBufferRegistry: invalid VBO handle");
+    return *buffer;
+}
+
+const VertexBuffer &VertexBufferRegistry::at(VBOHandle handle) const
+{
+    const VertexBuffer *buffer = get(handle);
+    if(!buffer) throw std::out_of_range("VertexBufferRegistry: invalid VBO handle");
+    return *buffer;
+}
+
+UploadStats VertexArray::uploadStats;
+
+int VertexArray::getVBOSize() const
+{
+    const VertexBuffer *vbo = VBOs.get(boundVBO);
+    return vbo ? vbo->size : 0;
+}
+
+VBOHandle VertexArray::createBuffer(const std::string &key, const void *data, int sizeBytes)
+{
     //Create Vertex Buffer Object and bind to global state.
-    unsigned int VBO;
-    glGenBuffers(1, &VBO);
-    glBindBuffer(GL_ARRAY_BUFFER, VBO);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), &vertices[0], GL_STATIC_DRAW);
+    VBOHandle handle = VBOs.add(key);
+    VertexBuffer &vbo = VBOs.at(handle);
+    if(vbo.id == 0){
+        glGenBuffers(1, &vbo.id);
+        setupVAO(vbo);
+    }
+    glBindBuffer(GL_ARRAY_BUFFER, vbo.id);
+    glBufferData(GL_ARRAY_BUFFER, sizeBytes, data, GL_STATIC_DRAW);
+    vbo.size = vbo.capacity = sizeBytes;
 
-    //Store vbo as id
-    VBOs[key] = VBO;
+    uploadStats.bytesUploaded += sizeBytes;
+    uploadStats.allocations++;
+    return handle;
+}
 
+void VertexArray::editBuffer(VertexBuffer &vbo, const void *data, int sizeBytes)
+{
+    glBindBuffer(GL_ARRAY_BUFFER, vbo.id);
+    if(sizeBytes > vbo.capacity){
+        //An edited buffer is likely to be edited again, leave a quarter for it to grow into
+        vbo.capacity = sizeBytes + sizeBytes / 4;
+        glBufferData(GL_ARRAY_BUFFER, vbo.capacity, nullptr, GL_DYNAMIC_DRAW);
+        uploadStats.allocations++;
+    }else{
+        uploadStats.subDataUploads++;
+    }
+    if(sizeBytes > 0) glBufferSubData(GL_ARRAY_BUFFER, 0, sizeBytes, data);
+    vbo.size = sizeBytes;
+    uploadStats.bytesUploaded += sizeBytes;
+}
+
+//Creates a vertex buffer object for vertices
+VBOHandle VertexArray::createVBO(std::string key, std::vector<float> vertices){
+    return createBuffer(key, vertices.data(), vertices.size() * sizeof(float));
+}
+
+//Creates a vertex buffer object for integer vertices
+VBOHandle VertexArray::createVBO(std::string key, const std::vector<uint32_t> &vertices){
+    return createBuffer(key, vertices.data(), vertices.size() * sizeof(uint32_t));
 }
 
 void VertexArray::editVBO(std::string key, std::vector<float> vertices)
 {
-    glBindBuffer(GL_ARRAY_BUFFER, VBOs[key]);
-    glBufferData(GL_ARRAY_BUFFER, vertices.size() * sizeof(float), &vertices[0], GL_STATIC_DRAW);
+    editBuffer(VBOs.at(VBOs.find(key)), vertices.data(), vertices.size() * sizeof(float));
 }   
 
-//Binds the current VBO of key to VAO.
+void VertexArray::editVBO(std::string key, const std::vector<uint32_t> &vertices)
+{
+    editVBO(VBOs.find(key), vertices);
+}
+
+void VertexArray::editVBO(VBOHandle handle, const std::vector<uint32_t> &vertices)
+{
+    editBuffer(VBOs.at(handle), vertices.data(), vertices.size() * sizeof(uint32_t));
+}
+
+void VertexArray::updateVBO(std::string key, int offsetBytes, const std::vector<uint32_t> &vertices)
+{
+    updateVBO(VBOs.find(key), offsetBytes, vertices);
+}
+
+void VertexArray::updateVBO(VBOHandle handle, int offsetBytes, const std::vector<uint32_t> &vertices)
+{
+    if(vertices.empty()) return;
+    glBindBuffer(GL_ARRAY_BUFFER, VBOs.at(handle).id);
+    glBufferSubData(GL_ARRAY_BUFFER, offsetBytes, vertices.size() * sizeof(uint32_t), vertices.data());
+    uploadStats.bytesUploaded += vertices.size() * sizeof(uint32_t);
+    uploadStats.subDataUploads++;
+}
+
+VBOHandle VertexArray::reserveVBO(std::string key, int capacityBytes)
+{
+    VBOHandle handle = VBOs.add(key);
+    VertexBuffer &vbo = VBOs.at(handle);
+    if(vbo.id != 0 && capacityBytes <= vbo.capacity) return handle;
+
+    unsigned int newId;
+    glGenBuffers(1, &newId);
+    glBindBuffer(GL_ARRAY_BUFFER, newId);
+    glBufferData(GL_ARRAY_BUFFER, capacityBytes, nullptr, GL_DYNAMIC_DRAW);
+    uploadStats.allocations++;
+
+    if(vbo.id != 0){
+        //Copy on the GPU, the data never comes back to the CPU
+        glBindBuffer(GL_COPY_READ_BUFFER, vbo.id);
+        glBindBuffer(GL_COPY_WRITE_BUFFER, newId);
+        glCopyBufferSubData(GL_COPY_READ_BUFFER, GL_COPY_WRITE_BUFFER, 0, 0, vbo.capacity);
+        glDeleteBuffers(1, &vbo.id);
+    }
+    vbo.id = newId;
+    vbo.size = vbo.capacity = capacityBytes;
+    //The VAO still points at the old buffer
+    setupVAO(vbo);
+    return handle;
+}
+
+void VertexArray::deleteVBO(VBOHandle handle)
+{
+    VertexBuffer *vbo = VBOs.get(handle);
+    if(!vbo) return;
+    glDeleteBuffers(1, &vbo->id);
+    glDeleteVertexArrays(1, &vbo->vao);
+    VBOs.remove(handle);
+}
+
+void VertexArray::createQuadIndexBuffer(int quadCount)
+{
+    std::vector<unsigned int> indices;
+    indices.reserve(quadCount * 6);
+    for(unsigned int quad = 0; quad < (unsigned int)quadCount; quad++){
+        unsigned int first = quad * 4;
+        indices.push_back(first);
+        indices.push_back(first + 1);
+        indices.push_back(first + 2);
+        indices.push_back(first + 2);
+        indices.push_back(first + 3);
+        indices.push_back(first);
+    }
+
+    //The element buffer binding is part of the VAO state, VBOs created later bind it in setupVAO
+    glBindVertexArray(VAO);
+    if(quadEBO == 0) glGenBuffers(1, &quadEBO);
+    glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, quadEBO);
+    glBufferData(GL_ELEMENT_ARRAY_BUFFER, indices.size() * sizeof(unsigned int), &indices[0], GL_STATIC_DRAW);
+    unsigned int ebo = quadEBO;
+    VBOs.forEach([ebo](VertexBuffer &vbo){
+        glBindVertexArray(vbo.vao);
+        glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+    });
+}
+
+//Binds the VAO of the VBO of key.
 void VertexArray::bindVBO(std::string key) const{
-    glBindBuffer(GL_ARRAY_BUFFER, VBOs.at(key));
-    
+    bindVBO(VBOs.find(key));
+}
+
+//Binds the VAO of the VBO of handle.
+void VertexArray::bindVBO(VBOHandle handle) const{
+    glBindVertexArray(VBOs.at(handle).vao);
+    boundVBO = handle;
+}
+
+void VertexArray::setupVAO(VertexBuffer &vbo)
+{
+    if(vbo.vao == 0) glGenVertexArrays(1, &vbo.vao);
+    glBindVertexArray(vbo.vao);
+    glBindBuffer(GL_ARRAY_BUFFER, vbo.id);
+    if(quadEBO != 0) glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, quadEBO);
+
     //Bind Vertex BufferObject to VAO
     if(vf == VertexFormat_Texture){
         //For format: x, y, z, tx, ty
@@ -85,13 +271,14 @@ void VertexArray::bindVBO(std::string key) const{
     }else if(vf == VertexFormat_Water){
         glVertexAttribPointer(0, 2, GL_FLOAT, GL_FALSE, 2 * sizeof(GL_FLOAT), (void*)0);
         glEnableVertexAttribArray(0);
-    }else if(vf == VertexFormat_Normal_RGB_Optimized){ // position + normal + color
-        glVertexAttribPointer(0, 1, GL_FLOAT, GL_FALSE, 1 * sizeof(GLfloat), (void*)0);
+    }else if(vf == VertexFormat_Packed){
+        //Integer attribute, so the bits reach the shader unconverted
+        glVertexAttribIPointer(0, 1, GL_UNSIGNED_INT, sizeof(GLuint), (void*)0);
         glEnableVertexAttribArray(0);
     }
 }
 
-int VertexArray::getVertexSizeBytes() const {
+int VertexArray::computeVertexSizeBytes(VertexFormat vf) {
     int size = sizeof(float);
 
     if(vf == VertexFormat_Texture){
@@ -106,8 +293,8 @@ int VertexArray::getVertexSizeBytes() const {
         size *= 9;
     }else if(vf == VertexFormat_Water){
         size *= 2;
-    }else if(vf == VertexFormat_Normal_RGB_Optimized){
-        size *= 1;
+    }else if(vf == VertexFormat_Packed){
+        size = sizeof(uint32_t);
     }
     
     return size;
@@ -2,6 +2,7 @@
 #define __VERTEXARRAY_H__
 
 #include <glad/glad.h>
+#include <cstdint>
 #include <map>
 #include <string>
 #include <vector>
@@ -13,32 +14,137 @@ enum VertexFormat{
     VertexFormat_Normal, //x, y, z, n1, n2, n3
     VertexFormat_Normal_RGB, //x, y, z, n1, n2, n3, r, g, b
     VertexFormat_Water, //x, z
-    VertexFormat_Normal_RGB_Optimized, // position(18 bits) | normal(6 bits) | color (2  bits)
+    VertexFormat_Packed, // one uint32: position(18 bits) | face(3 bits) | ao(2 bits) | material(8 bits)
+};
+
+//Buffer upload counters of every VertexArray, reset once per frame
+struct UploadStats {
+    size_t bytesUploaded = 0; // vertex data sent with glBufferData or glBufferSubData
+    int subDataUploads = 0;   // uploads written into existing storage
+    int allocations = 0;      // glBufferData calls that (re)allocated storage
+};
+
+//A VBO keeps headroom past its data, so edits that still fit are written with glBufferSubData
+//instead of reallocating the buffer. Each VBO has its own VAO holding its vertex layout, set up once.
+struct VertexBuffer {
+    unsigned int id = 0;
+    unsigned int vao = 0;
+    int size = 0;     // bytes of vertex data
+    int capacity = 0; // bytes of storage
+};
+
+//Refers to a VBO of a VertexArray without a string lookup. The generation makes handles to a deleted VBO
+//invalid, even once its slot is reused by a new VBO.
+struct VBOHandle {
+    uint32_t index = 0;
+    uint32_t generation = 0; // 0 is never live
+    bool isValid() const { return generation != 0; }
+    bool operator==(const VBOHandle &other) const { return index == other.index && generation == other.generation; }
+    bool operator!=(const VBOHandle &other) const { return !(*this == other); }
+};
+
+//VertexBuffers stored in slots addressed by VBOHandle. String keys map to handles, so they are only
+//looked up once when a caller keeps the handle.
+class VertexBufferRegistry {
+public:
+    //Handle of key's VBO, adding an empty one when key is new
+    VBOHandle add(const std::string &key);
+    void remove(VBOHandle handle);
+    //Invalid handle when key has no VBO
+    VBOHandle find(const std::string &key) const;
+
+    //nullptr for invalid or stale handles
+    VertexBuffer *get(VBOHandle handle) {
+        if(handle.index >= slots.size() || slots[handle.index].generation != handle.generation) return nullptr;
+        return &slots[handle.index].buffer;
+    }
+    const VertexBuffer *get(VBOHandle handle) const {
+        if(handle.index >= slots.size() || slots[handle.index].generation != handle.generation) return nullptr;
+        return &slots[handle.index].buffer;
+    }
+    VertexBuffer &at(VBOHandle handle);
+    const VertexBuffer &at(VBOHandle handle) const;
+
+    //Calls f on every VBO
+    template<typename F> void forEach(F f) {
+        for(Slot &slot : slots){
+            if(slot.live) f(slot.buffer);
+        }
+    }
+
+private:
+    struct Slot {
+        VertexBuffer buffer;
+        std::string key;
+        uint32_t generation = 1; // bumped when the VBO is removed, so no handle matches a free slot
+        bool live = false;
+    };
+    std::vector<Slot> slots;
+    std::vector<uint32_t> freeSlots;
+    std::map<std::string, VBOHandle> keys;
 };
 
 class VertexArray 
 {
 public:
-    unsigned int VAO; //Vertex array object
+    unsigned int VAO; //Vertex array object bound while no VBO is
     VertexFormat vf;
-    std::map<std::string, unsigned int> VBOs; //maps key to a VBO id
+    VertexBufferRegistry VBOs; //maps key and handles to a VBO
+    unsigned int quadEBO; //Index buffer shared by every VBO, 0 when drawing non-indexed
 
     VertexArray();
     VertexArray(VertexFormat vf);
+    //Binds the VAO of the last bound VBO
     void bind() const;
 
-    //Gets size of current vbo 
+    //Gets size of the vertex data of the last bound vbo, from the CPU side copy
     int getVBOSize() const;
+    int getVertexCount() const { return getVBOSize() / vertexSizeBytes; }
     VertexFormat getCurrentVertexFormat() const;
-    int getVertexSizeBytes() const;
+    int getVertexSizeBytes() const { return vertexSizeBytes; }
+    //Handle of key's VBO, invalid when there is none. Keep it to skip the key lookup in per frame code.
+    VBOHandle getVBOHandle(const std::string &key) const { return VBOs.find(key); }
+
     //Creates VBO Object
-    void createVBO(std::string key, std::vector<float> vertices);
+    VBOHandle createVBO(std::string key, std::vector<float> vertices);
+    VBOHandle createVBO(std::string key, const std::vector<uint32_t> &vertices);
 
-    //Edits VBO Object
+    //Edits VBO Object, reallocating with headroom only when vertices outgrow its storage
     void editVBO(std::string key, std::vector<float> vertices);
+    void editVBO(std::string key, const std::vector<uint32_t> &vertices);
+    void editVBO(VBOHandle handle, const std::vector<uint32_t> &vertices);
+    //Overwrites part of the VBO in place, starting offsetBytes into it. The VBO keeps its size.
+    void updateVBO(std::string key, int offsetBytes, const std::vector<uint32_t> &vertices);
+    void updateVBO(VBOHandle handle, int offsetBytes, const std::vector<uint32_t> &vertices);
+    //Makes sure the VBO has at least capacityBytes of storage, creating it empty or growing it with its contents kept.
+    //Meant for VBOs that are carved into ranges with updateVBO, so its size is set to the whole storage.
+    VBOHandle reserveVBO(std::string key, int capacityBytes);
+    //Deletes the VBO, its handles become invalid
+    void deleteVBO(VBOHandle handle);
+
+    static const UploadStats &getUploadStats() { return uploadStats; }
+    static void resetUploadStats() { uploadStats = UploadStats(); }
 
-    //Binds Vertex buffer object to VAO
+    //Binds the VAO of the VBO, which already holds its vertex layout
     void bindVBO(std::string key) const;
+    void bindVBO(VBOHandle handle) const;
+
+    //Builds the index buffer for VBOs of quads (4 vertices each, triangles (0, 1, 2) and (2, 3, 0)).
+    //Built once for the largest VBO and used by all of them, since the pattern only depends on quad number.
+    void createQuadIndexBuffer(int quadCount);
+    bool hasQuadIndices() const { return quadEBO != 0; }
+
+private:
+    static UploadStats uploadStats;
+    mutable VBOHandle boundVBO;
+    int vertexSizeBytes;
+
+    static int computeVertexSizeBytes(VertexFormat vf);
+    //Points vbo's VAO at its buffer with the layout of vf, creating the VAO the first time
+    void setupVAO(VertexBuffer &vbo);
+
+    VBOHandle createBuffer(const std::string &key, const void *data, int sizeBytes);
+    void editBuffer(VertexBuffer &vbo, const void *data, int sizeBytes);
 };
 
 
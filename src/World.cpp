@@ -0,0 +1,415 @@
+#include "World.h"
+#include <algorithm>
+#include <bitset>
+
+//Grid offset (di, dj) of the neighbour on each chunk side. Local +z points to world +z, which is row j - 1.
+static const int SIDE_OFFSETS[ChunkSide_Count][2] = {
+    { 0,  1}, // ChunkSide_NegZ
+    { 0, -1}, // ChunkSide_PosZ
+    {-1,  0}, // ChunkSide_NegX
+    { 1,  0}, // ChunkSide_PosX
+};
+
+//NegZ <-> PosZ, NegX <-> PosX
+static ChunkSide getOppositeSide(int side)
+{
+    return (ChunkSide)(side ^ 1);
+}
+
+//Regions touching a chunk side, whose border faces depend on the neighbour there
+static uint32_t getSideRegions(int side)
+{
+    uint32_t regions = 0;
+    for(int r = 0; r < ChunkMesher::REGION_COUNT; r++){
+        MeshRegion region = ChunkMesher::getRegion(r);
+        if((side == ChunkSide_NegZ && region.min[2] == 0) || (side == ChunkSide_PosZ && region.max[2] == Chunk::CHUNK_SIZE) ||
+           (side == ChunkSide_NegX && region.min[0] == 0) || (side == ChunkSide_PosX && region.max[0] == Chunk::CHUNK_SIZE)){
+            regions |= 1u << r;
+        }
+    }
+    return regions;
+}
+
+//Span of a region in the chunk's VBO: its vertices plus SPAN_HEADROOM_FACES faces of room,
+//so most single block edits are written in place instead of laying the whole chunk out again
+static int getSpanSize(int vertexCount)
+{
+    return vertexCount + World::SPAN_HEADROOM_FACES * ChunkMesher::VERTICES_PER_FACE;
+}
+
+World::World(int worldSize, ChunkStorageMode chunkStorageMode, int threadCount, HeightTileCache *heightCache)
+    : size(worldSize), storageMode(chunkStorageMode),
+      ownHeightCache(heightCache ? nullptr : std::make_unique<HeightTileCache>()),
+      heightField(terrain, heightCache ? *heightCache : *ownHeightCache), pool(threadCount)
+{
+    chunks.resize(size * size);
+    loading.assign(size * size, false);
+    edited.assign(size * size, false);
+    blocksChanged.assign(size * size, false);
+    meshes.resize(size * size);
+}
+
+Chunk *World::getChunk(int i, int j) const
+{
+    if(!isInside(i, j)) return nullptr;
+    return chunks[getIndex(i, j)].get();
+}
+
+const char *const World::MESH_BUFFER_KEY = "World";
+
+const ChunkHeights *World::getChunkHeights(int i, int j) const
+{
+    if(!isInside(i, j) || meshes[getIndex(i, j)].blocksVersion == 0) return nullptr;
+    return &meshes[getIndex(i, j)].heights;
+}
+
+ChunkConnectivity World::getConnectivity(int i, int j) const
+{
+    if(!isInside(i, j) || meshes[getIndex(i, j)].blocksVersion == 0) return ChunkConnectivity();
+    return meshes[getIndex(i, j)].connectivity;
+}
+
+void World::findVisibleChunks(int i, int j, int x, int y, int z, std::vector<bool> &visible) const
+{
+    if(!isInside(i, j) || y < 0 || y >= Chunk::CHUNK_SIZE){
+        visible.assign(size * size, true);
+        return;
+    }
+    visible.assign(size * size, false);
+    visible[getIndex(i, j)] = true;
+
+    //Moves along x and z so far, per axis 0 for none, 1 for negative and 2 for positive. A chunk is visited
+    //once per entry opening and moves, as different paths through it can lead on to different chunks.
+    const int MOVE_STATES = 9;
+    struct Visit {
+        int i, j;
+        int entry; // side opening it was entered through
+        int moves; // x moves * 3 + z moves
+    };
+    std::vector<Visit> queue;
+    std::vector<std::bitset<ChunkConnectivity::SIDE_OPENINGS * MOVE_STATES>> visited(size * size);
+
+    //Into the neighbour through each side opening of exits
+    auto leave = [&](int ci, int cj, uint32_t exits, int moves){
+        for(int opening = 0; opening < ChunkConnectivity::SIDE_OPENINGS; opening++){
+            if(!(exits & (1u << opening))) continue;
+            int side = opening / ChunkConnectivity::BANDS;
+            int axisShift = side == ChunkSide_NegX || side == ChunkSide_PosX ? 3 : 1;
+            int axisMoves = moves / axisShift % 3;
+            int move = side == ChunkSide_NegZ || side == ChunkSide_NegX ? 1 : 2;
+            if(axisMoves != 0 && axisMoves != move) continue;
+
+            int ni = ci + SIDE_OFFSETS[side][0], nj = cj + SIDE_OFFSETS[side][1];
+            if(!isInside(ni, nj)) continue;
+            int entry = getOppositeSide(side) * ChunkConnectivity::BANDS + opening % ChunkConnectivity::BANDS;
+            int nextMoves = moves + (move - axisMoves) * axisShift;
+            int state = entry * MOVE_STATES + nextMoves;
+            if(visited[getIndex(ni, nj)][state]) continue;
+            visited[getIndex(ni, nj)][state] = true;
+            visible[getIndex(ni, nj)] = true;
+            queue.push_back(Visit{ni, nj, entry, nextMoves});
+        }
+    };
+
+    //A camera inside a block or an unloaded chunk could be looking anywhere
+    Chunk *chunk = getChunk(i, j);
+    uint32_t exits = ChunkConnectivity::ALL_OPENINGS;
+    if(chunk && !chunk->isActive(x, y, z)) exits = ChunkConnectivity::getReachableOpenings(chunk->getStorage(), x, y, z);
+    leave(i, j, exits, 0);
+
+    for(size_t next = 0; next < queue.size(); next++){
+        Visit visit = queue[next];
+        leave(visit.i, visit.j, getConnectivity(visit.i, visit.j).getConnected(visit.entry), visit.moves);
+    }
+}
+
+MeshRange World::getMeshRange(int i, int j) const
+{
+    if(!isInside(i, j)) return MeshRange();
+    return meshes[getIndex(i, j)].range;
+}
+
+void World::loadChunk(int i, int j)
+{
+    int index = getIndex(i, j);
+    if(!isInside(i, j) || loading[index] || chunks[index]) return;
+    loading[index] = true;
+
+    queuedJobs++;
+    ChunkStorageMode chunkStorageMode = storageMode;
+    pool.submit([this, index, i, j, chunkStorageMode]{
+        std::unique_ptr<Chunk> chunk = std::make_unique<Chunk>(chunkStorageMode);
+        chunk->setupLandscape(heightField, Chunk::CHUNK_SIZE * (i + 2), Chunk::CHUNK_SIZE * (j + 2));
+
+        std::lock_guard<std::mutex> lock(resultMutex);
+        generatedChunks.push_back(GeneratedChunk{index, std::move(chunk)});
+    });
+}
+
+bool World::setBlock(int i, int j, int x, int y, int z, BlockType type)
+{
+    Chunk *chunk = getChunk(i, j);
+    if(!chunk) return false;
+    chunk->setBlock(x, y, z, type);
+    blocksChanged[getIndex(i, j)] = true;
+    markBlockDirty(i, j, x, y, z);
+    return true;
+}
+
+bool World::removeBlock(int i, int j, int x, int y, int z)
+{
+    Chunk *chunk = getChunk(i, j);
+    if(!chunk) return false;
+    chunk->removeBlock(x, y, z);
+    blocksChanged[getIndex(i, j)] = true;
+    markBlockDirty(i, j, x, y, z);
+    return true;
+}
+
+void World::markBlockDirty(int i, int j, int x, int y, int z)
+{
+    //The chunk marked its own regions in setBlock, the block's neighbours across the chunk border
+    //are on the opposite border of the neighbouring chunk
+    const int last = Chunk::CHUNK_SIZE - 1;
+    edited[getIndex(i, j)] = true;
+    int touching[ChunkSide_Count][3] = {
+        {x, y, last}, // ChunkSide_NegZ
+        {x, y, 0},    // ChunkSide_PosZ
+        {last, y, z}, // ChunkSide_NegX
+        {0, y, z},    // ChunkSide_PosX
+    };
+    bool onSide[ChunkSide_Count] = {z == 0, z == last, x == 0, x == last};
+
+    for(int side = 0; side < ChunkSide_Count; side++){
+        if(!onSide[side]) continue;
+        int ni = i + SIDE_OFFSETS[side][0];
+        int nj = j + SIDE_OFFSETS[side][1];
+        Chunk *neighbour = getChunk(ni, nj);
+        if(!neighbour) continue;
+
+        const int *p = touching[side];
+        neighbour->markRegionsDirty(1u << ChunkMesher::getRegionIndex(p[0], p[1], p[2]));
+        edited[getIndex(ni, nj)] = true;
+    }
+}
+
+void World::processJobs()
+{
+    std::vector<GeneratedChunk> generated;
+    std::vector<MeshedChunk> meshed;
+    {
+        std::lock_guard<std::mutex> lock(resultMutex);
+        generated.swap(generatedChunks);
+        meshed.swap(meshedChunks);
+    }
+
+    for(GeneratedChunk &result : generated){
+        addChunk(result.index, std::move(result.chunk));
+        queuedJobs--;
+    }
+
+    //Edits are a few regions, meshing them here keeps them out of the queue behind whole chunks
+    for(int index = 0; index < size * size; index++){
+        if(!chunks[index] || !chunks[index]->getDirtyRegions()) continue;
+        meshDirtyRegions(index, edited[index]);
+        edited[index] = false;
+    }
+
+    for(MeshedChunk &result : meshed){
+        queuedJobs--;
+        applyMesh(result);
+    }
+    updateMeshStats();
+}
+
+void World::finishJobs()
+{
+    processJobs();
+    while(hasPendingJobs()){
+        pool.waitIdle();
+        processJobs();
+    }
+}
+
+void World::addChunk(int index, std::unique_ptr<Chunk> chunk)
+{
+    int i = index / size, j = index % size;
+    chunk->setMeshMode(meshMode);
+    chunk->markRegionsDirty(ChunkMesher::ALL_REGIONS);
+    chunks[index] = std::move(chunk);
+    loading[index] = false;
+    blocksChanged[index] = true;
+
+    //Link both ways, the neighbour's border faces against this chunk are now hidden
+    Chunk *loaded = chunks[index].get();
+    for(int side = 0; side < ChunkSide_Count; side++){
+        Chunk *neighbour = getChunk(i + SIDE_OFFSETS[side][0], j + SIDE_OFFSETS[side][1]);
+        if(!neighbour) continue;
+
+        loaded->setNeighbour((ChunkSide)side, neighbour);
+        neighbour->setNeighbour(getOppositeSide(side), loaded);
+        neighbour->markRegionsDirty(getSideRegions(getOppositeSide(side)));
+    }
+}
+
+//Meshes a snapshot of the blocks and halo, so on the pool the chunk and its neighbours
+//can keep changing on the main thread while the job runs
+void World::meshDirtyRegions(int index, bool now)
+{
+    Chunk *chunk = chunks[index].get();
+    chunk->updateHalo();
+    uint32_t regions = chunk->takeDirtyRegions();
+    bool changed = blocksChanged[index];
+    blocksChanged[index] = false;
+    unsigned int version = ++meshVersion;
+    for(int r = 0; r < REGION_COUNT; r++){
+        if(regions & (1u << r)) meshes[index].regionVersions[r] = version;
+    }
+
+    if(now){
+        MeshedChunk result;
+        result.index = index;
+        result.version = version;
+        result.regions = regions;
+        result.blocksChanged = changed;
+        meshRegions(chunk->getStorage(), chunk->getHalo(), chunk->getMeshMode(), result);
+        applyMesh(result);
+        return;
+    }
+
+    ChunkStorage blocks = chunk->getStorage();
+    ChunkHalo halo = chunk->getHalo();
+    MeshMode mode = chunk->getMeshMode();
+    queuedJobs++;
+    pool.submit([this, index, version, regions, changed, blocks, halo, mode]{
+        MeshedChunk result;
+        result.index = index;
+        result.version = version;
+        result.regions = regions;
+        result.blocksChanged = changed;
+        meshRegions(blocks, halo, mode, result);
+
+        std::lock_guard<std::mutex> lock(resultMutex);
+        meshedChunks.push_back(std::move(result));
+    });
+}
+
+void World::meshRegions(const ChunkStorage &blocks, const ChunkHalo &halo, MeshMode mode, MeshedChunk &result)
+{
+    for(int r = 0; r < REGION_COUNT; r++){
+        if(!(result.regions & (1u << r))) continue;
+        result.vertices[r] = ChunkMesher::mesh(blocks, halo, mode, ChunkMesher::getRegion(r), result.stats[r]);
+    }
+
+    //Whole chunk, but only when its blocks changed rather than just its neighbours or the mesh mode
+    if(!result.blocksChanged) return;
+    result.connectivity = ChunkConnectivity::compute(blocks);
+
+    uint32_t any = 0;
+    for(int tile = 0; tile < ChunkHeights::TILES * ChunkHeights::TILES; tile++){
+        int x0 = tile % ChunkHeights::TILES * ChunkHeights::TILE_SIZE, z0 = tile / ChunkHeights::TILES * ChunkHeights::TILE_SIZE;
+        uint32_t all = 0xFFFFFFFFu;
+        for(int x = x0; x < x0 + ChunkHeights::TILE_SIZE; x++){
+            for(int z = z0; z < z0 + ChunkHeights::TILE_SIZE; z++){
+                uint32_t mask = blocks.columnMask(x, z);
+                all &= mask;
+                any |= mask;
+            }
+        }
+        int height = 0;
+        while(height < Chunk::CHUNK_SIZE && ((all >> height) & 1)) height++;
+        result.heights.solid[tile] = (uint8_t)height;
+    }
+    int top = Chunk::CHUNK_SIZE;
+    while(top > 0 && !((any >> (top - 1)) & 1)) top--;
+    result.heights.top = (uint8_t)top;
+}
+
+void World::applyMesh(MeshedChunk &result)
+{
+    ChunkMesh &mesh = meshes[result.index];
+    MeshStats chunkStats;
+    for(int r = 0; r < REGION_COUNT; r++){
+        //A region changed again after this mesh was queued, a newer one is on its way
+        if((result.regions & (1u << r)) && mesh.regionVersions[r] == result.version){
+            mesh.regions[r] = std::move(result.vertices[r]);
+            mesh.regionStats[r] = result.stats[r];
+            mesh.changedRegions |= 1u << r;
+        }
+        chunkStats += mesh.regionStats[r];
+    }
+    //Results can arrive out of order, keep what the newest blocks gave
+    if(result.blocksChanged && result.version >= mesh.blocksVersion){
+        mesh.heights = result.heights;
+        mesh.connectivity = result.connectivity;
+        mesh.blocksVersion = result.version;
+    }
+    chunks[result.index]->setMeshStats(chunkStats);
+}
+
+void World::uploadMeshes(VertexArray &worldVAO)
+{
+    for(int index = 0; index < size * size; index++){
+        ChunkMesh &mesh = meshes[index];
+        if(!mesh.changedRegions) continue;
+
+        bool fits = mesh.range.vertexCount > 0;
+        for(int r = 0; r < REGION_COUNT && fits; r++){
+            if((mesh.changedRegions & (1u << r)) && (int)mesh.regions[r].size() > mesh.spanSizes[r]) fits = false;
+        }
+
+        if(fits){
+            //Patch the changed spans, padding them with degenerate quads
+            for(int r = 0; r < REGION_COUNT; r++){
+                if(!(mesh.changedRegions & (1u << r))) continue;
+                std::vector<PackedVertex> span(mesh.regions[r]);
+                span.resize(mesh.spanSizes[r], 0);
+                worldVAO.updateVBO(meshBuffer, (mesh.range.firstVertex + mesh.spanOffsets[r]) * sizeof(PackedVertex), span);
+            }
+        }else{
+            //Lay the regions out again, each span with headroom for edits, in a new range
+            std::vector<PackedVertex> vertices;
+            for(int r = 0; r < REGION_COUNT; r++){
+                mesh.spanOffsets[r] = (int)vertices.size();
+                mesh.spanSizes[r] = getSpanSize((int)mesh.regions[r].size());
+                vertices.insert(vertices.end(), mesh.regions[r].begin(), mesh.regions[r].end());
+                vertices.resize(mesh.spanOffsets[r] + mesh.spanSizes[r], 0);
+            }
+            if(mesh.range.vertexCount > 0) meshAllocator.free(mesh.range.firstVertex);
+            mesh.range.vertexCount = (int)vertices.size();
+            mesh.range.firstVertex = allocateMeshRange(worldVAO, mesh.range.vertexCount);
+            worldVAO.updateVBO(meshBuffer, mesh.range.firstVertex * sizeof(PackedVertex), vertices);
+        }
+        mesh.changedRegions = 0;
+    }
+}
+
+int World::allocateMeshRange(VertexArray &worldVAO, int vertexCount)
+{
+    int first = meshAllocator.allocate(vertexCount);
+    if(first != FreeListAllocator::INVALID_OFFSET) return first;
+
+    int capacity = std::max(meshAllocator.getCapacity() * 2, INITIAL_MESH_BUFFER_VERTICES);
+    while(capacity - meshAllocator.getCapacity() < vertexCount) capacity *= 2;
+    meshAllocator.grow(capacity);
+    meshBuffer = worldVAO.reserveVBO(MESH_BUFFER_KEY, capacity * sizeof(PackedVertex));
+    return meshAllocator.allocate(vertexCount);
+}
+
+void World::setMeshMode(MeshMode mode)
+{
+    meshMode = mode;
+    for(int index = 0; index < size * size; index++){
+        if(!chunks[index]) continue;
+        chunks[index]->setMeshMode(mode);
+        chunks[index]->markRegionsDirty(ChunkMesher::ALL_REGIONS);
+    }
+}
+
+void World::updateMeshStats()
+{
+    meshStats = MeshStats();
+    for(const std::unique_ptr<Chunk> &chunk : chunks){
+        if(chunk) meshStats += chunk->getMeshStats();
+    }
+}
@@ -0,0 +1,175 @@
+#ifndef __WORLD_H__
+#define __WORLD_H__
+
+#include "Chunk.h"
+#include "ChunkConnectivity.h"
+#include "FreeListAllocator.h"
+#include "HeightField.h"
+#include "TerrainGenerator.h"
+#include "ThreadPool.h"
+#include "VertexArray.h"
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//Vertices [firstVertex, firstVertex + vertexCount) of the world's mesh VBO
+struct MeshRange {
+    int firstVertex = 0;
+    int vertexCount = 0;
+};
+
+//Vertical extent of a chunk's blocks, for culling. Heights count blocks from the bottom of the chunk.
+struct ChunkHeights {
+    static const int TILES = 4; // per side
+    static const int TILE_SIZE = Chunk::CHUNK_SIZE / TILES;
+
+    //Per tile of TILE_SIZE x TILE_SIZE columns, indexed tileX + tileZ * TILES: blocks solid in every column
+    uint8_t solid[TILES * TILES] = {};
+    //Above the highest block of the chunk, 0 when it is all air
+    uint8_t top = 0;
+};
+
+//Square grid of chunks. Chunk (i, j) is drawn at x = i, z = -j.
+//Keeps neighbouring chunks linked and re-meshes the regions of chunks whose blocks or neighbours changed.
+//Generation and meshing run on a worker pool; chunks are only linked, edited and uploaded on the main thread.
+class World {
+public:
+    //threadCount 0 picks the worker count from the core count.
+    //Terrain heights are kept in heightCache when given, so a later World sharing it skips generating them,
+    //otherwise in a cache of the world's own.
+    World(int size, ChunkStorageMode storageMode = ChunkStorageMode_Flat, int threadCount = 0, HeightTileCache *heightCache = nullptr);
+
+    int getSize() const { return size; }
+    //Chunk at grid position (i, j), nullptr when out of range or not loaded yet
+    Chunk *getChunk(int i, int j) const;
+    //Mesh of chunk (i, j) as a range of MESH_BUFFER_KEY's VBO, vertexCount 0 when it has none yet
+    MeshRange getMeshRange(int i, int j) const;
+    const TerrainGenerator &getTerrain() const { return terrain; }
+    HeightField &getHeightField() { return heightField; }
+    int getThreadCount() const { return pool.getThreadCount(); }
+
+    //Queues generation of chunk (i, j). When done it is linked with its loaded neighbours and they are all re-meshed.
+    void loadChunk(int i, int j);
+
+    //Block edits in chunk (i, j). Only the touched regions are re-meshed, in the next processJobs on the main thread,
+    //so the edit is visible the same frame. Edits on the chunk border also re-mesh the neighbour's border region.
+    //Return false when the chunk is not loaded.
+    bool setBlock(int i, int j, int x, int y, int z, BlockType type);
+    bool removeBlock(int i, int j, int x, int y, int z);
+
+    //Main thread, once per frame: adds generated chunks, re-meshes edited regions, queues meshing of
+    //other dirty chunks and collects finished meshes for uploadMeshes. Never waits on the workers.
+    void processJobs();
+    //Blocks until every queued generation and meshing job has finished and been collected
+    void finishJobs();
+    bool hasPendingJobs() const { return queuedJobs > 0; }
+
+    //Every chunk mesh lives in one VBO of worldVAO, carved into a range per chunk
+    static const char *const MESH_BUFFER_KEY;
+    //Faces of headroom each region's span keeps for edits, one block's worth
+    static const int SPAN_HEADROOM_FACES = ChunkMesher::FACE_COUNT;
+    //Most quads a chunk's range can hold, its largest mesh plus the headroom of every span.
+    //The quad index buffer of worldVAO must cover this many.
+    static const int MAX_CHUNK_QUADS = ChunkMesher::MAX_FACES + ChunkMesher::REGION_COUNT * SPAN_HEADROOM_FACES;
+    //Handle of that VBO, invalid before the first upload
+    VBOHandle getMeshBuffer() const { return meshBuffer; }
+
+    //Uploads every changed mesh region, in place when it still fits its span of the chunk's range.
+    //Otherwise the chunk gets a new range, growing the VBO when no free range is large enough.
+    void uploadMeshes(VertexArray &worldVAO);
+
+    //Switches every chunk to mode and marks it for re-meshing
+    void setMeshMode(MeshMode mode);
+    //Sum of the stats of every chunk's last mesh
+    const MeshStats &getMeshStats() const { return meshStats; }
+    //Heights of chunk (i, j) as of its newest mesh, nullptr when it has not been meshed yet
+    const ChunkHeights *getChunkHeights(int i, int j) const;
+    //Connectivity of chunk (i, j) as of its newest mesh, fully open when it has not been meshed yet
+    ChunkConnectivity getConnectivity(int i, int j) const;
+    //Sets visible[i * getSize() + j] for every chunk the camera at block (x, y, z) of chunk (i, j) could see
+    //through air. Breadth first from the camera's air pocket, leaving each chunk only through openings connected
+    //to the one it was entered by and never turning back along an axis it already moved along, as a line of
+    //sight cannot. From outside the chunks' box (above the terrain or off the grid) every chunk is visible.
+    void findVisibleChunks(int i, int j, int x, int y, int z, std::vector<bool> &visible) const;
+
+    //Usage of the mesh VBO, in vertices
+    AllocatorStats getMeshBufferStats() const { return meshAllocator.getStats(); }
+
+private:
+    static const int REGION_COUNT = ChunkMesher::REGION_COUNT;
+
+    //Vertices the mesh VBO starts with, it doubles when full
+    static const int INITIAL_MESH_BUFFER_VERTICES = 1 << 20;
+
+    //CPU copy of a chunk's mesh. Its range of the mesh VBO holds the regions back to back, each in a span of
+    //spanSizes[r] vertices; the unused end of a span is zero vertices, which make degenerate quads.
+    struct ChunkMesh {
+        std::vector<PackedVertex> regions[REGION_COUNT];
+        MeshStats regionStats[REGION_COUNT];
+        unsigned int regionVersions[REGION_COUNT] = {}; // version of the newest meshing queued per region
+        int spanOffsets[REGION_COUNT] = {};
+        int spanSizes[REGION_COUNT] = {};
+        //Derived from the blocks at the newest meshing that saw them change, 0 before the first one
+        ChunkHeights heights;
+        ChunkConnectivity connectivity;
+        unsigned int blocksVersion = 0;
+        uint32_t changedRegions = 0; // meshed but not uploaded yet
+        MeshRange range;             // vertexCount 0 until first uploaded
+    };
+
+    struct GeneratedChunk {
+        int index;
+        std::unique_ptr<Chunk> chunk;
+    };
+    struct MeshedChunk {
+        int index;
+        unsigned int version; // regionVersions value the regions were queued with
+        uint32_t regions;
+        std::vector<PackedVertex> vertices[REGION_COUNT];
+        MeshStats stats[REGION_COUNT];
+        bool blocksChanged; // since the chunk's last meshing, else heights and connectivity are left out
+        ChunkHeights heights;
+        ChunkConnectivity connectivity;
+    };
+
+    int size;
+    ChunkStorageMode storageMode;
+    MeshMode meshMode = MeshMode_Culled;
+    TerrainGenerator terrain;
+    std::unique_ptr<HeightTileCache> ownHeightCache; // when no cache is shared with the world
+    HeightField heightField; // heights of terrain, shared by every chunk
+    std::vector<std::unique_ptr<Chunk>> chunks;
+    std::vector<bool> loading;
+    std::vector<bool> edited; // chunk has regions dirtied by block edits
+    std::vector<bool> blocksChanged; // chunk's own blocks changed since it was last meshed
+    std::vector<ChunkMesh> meshes;
+    unsigned int meshVersion = 0;
+    MeshStats meshStats;
+    FreeListAllocator meshAllocator;
+    VBOHandle meshBuffer;
+    int queuedJobs = 0;
+
+    //Filled by the workers, drained by processJobs
+    std::mutex resultMutex;
+    std::vector<GeneratedChunk> generatedChunks;
+    std::vector<MeshedChunk> meshedChunks;
+
+    //Declared last so the workers are joined before anything they write to is destroyed
+    ThreadPool pool;
+
+    bool isInside(int i, int j) const { return i >= 0 && i < size && j >= 0 && j < size; }
+    int getIndex(int i, int j) const { return i * size + j; }
+    void addChunk(int index, std::unique_ptr<Chunk> chunk);
+    //Marks the regions a change to block (x, y, z) of chunk (i, j) affects, in it and its neighbours
+    void markBlockDirty(int i, int j, int x, int y, int z);
+    //Snapshots the chunk's dirty regions, meshing them now or on the pool
+    void meshDirtyRegions(int index, bool now);
+    static void meshRegions(const ChunkStorage &blocks, const ChunkHalo &halo, MeshMode mode, MeshedChunk &result);
+    void applyMesh(MeshedChunk &result);
+    void updateMeshStats();
+    //First vertex of a new range of vertexCount vertices in the mesh VBO, growing it when needed
+    int allocateMeshRange(VertexArray &worldVAO, int vertexCount);
+};
+
+#endif // __WORLD_H__
@@ -0,0 +1,185 @@
+#include "WorldRenderer.h"
+#include <algorithm>
+#include <chrono>
+
+//GL 4.0 enum, not in the GL 3.3 glad header
+#ifndef GL_DRAW_INDIRECT_BUFFER
+#define GL_DRAW_INDIRECT_BUFFER 0x8F3F
+#endif
+
+WorldRenderer::WorldRenderer(VertexArray &vao, GLADloadproc load) : worldVAO(vao)
+{
+    //baseInstance in indirect commands is only honoured from GL 4.2, and the function is GL 4.3
+    GLint major = 0, minor = 0;
+    glGetIntegerv(GL_MAJOR_VERSION, &major);
+    glGetIntegerv(GL_MINOR_VERSION, &minor);
+    if(major > 4 || (major == 4 && minor >= 3)){
+        multiDrawElementsIndirect = (MultiDrawElementsIndirectProc)load("glMultiDrawElementsIndirect");
+    }
+    useMultiDraw = hasMultiDrawIndirect();
+
+    glGenBuffers(1, &indirectBuffer);
+    glGenBuffers(1, &chunkBuffer);
+}
+
+WorldRenderer::~WorldRenderer()
+{
+    glDeleteBuffers(1, &indirectBuffer);
+    glDeleteBuffers(1, &chunkBuffer);
+}
+
+void WorldRenderer::update(const World &world, const glm::vec3 &eye)
+{
+    if(world.getMeshBuffer() != meshBuffer){
+        meshBuffer = world.getMeshBuffer();
+        if(!meshBuffer.isValid()) return;
+
+        //Added to the layout of the mesh VBO's VAO once. Draw i reads element i of the chunk positions,
+        //as every draw is a single instance starting at baseInstance i.
+        worldVAO.bindVBO(meshBuffer);
+        glBindBuffer(GL_ARRAY_BUFFER, chunkBuffer);
+        glVertexAttribIPointer(CHUNK_ATTRIBUTE, 2, GL_INT, 2 * sizeof(GLint), (void*)0);
+        glVertexAttribDivisor(CHUNK_ATTRIBUTE, 1);
+    }
+
+    std::vector<DrawElementsIndirectCommand> newCommands;
+    std::vector<GLint> newPositions;
+    chunkHeights.clear();
+    for(int i = 0; i < world.getSize(); i++){
+        for(int j = 0; j < world.getSize(); j++){
+            MeshRange range = world.getMeshRange(i, j);
+            if(range.vertexCount == 0) continue;
+
+            DrawElementsIndirectCommand command;
+            command.count = range.vertexCount / 4 * 6; //4 vertices and 6 indices per quad
+            command.instanceCount = 1;
+            command.firstIndex = 0;
+            command.baseVertex = range.firstVertex;
+            command.baseInstance = (GLuint)newCommands.size();
+            newCommands.push_back(command);
+            newPositions.push_back(i);
+            newPositions.push_back(j);
+            //A chunk is meshed before it is uploaded, so it always has heights here
+            const ChunkHeights *heights = world.getChunkHeights(i, j);
+            chunkHeights.push_back(heights ? *heights : ChunkHeights());
+        }
+    }
+
+    //Ranges only move when a chunk outgrows its own, most frames the list is unchanged
+    bool changed = newCommands.size() != commands.size() || newPositions != chunkPositions;
+    for(size_t d = 0; d < commands.size() && !changed; d++){
+        changed = newCommands[d].count != commands[d].count || newCommands[d].baseVertex != commands[d].baseVertex;
+    }
+    if(changed){
+        commands.swap(newCommands);
+        chunkPositions.swap(newPositions);
+        positionsDirty = true;
+    }
+
+    if(!connectivityCulling){
+        reachable.assign(commands.size(), true);
+        return;
+    }
+    int eyeI, eyeJ;
+    glm::ivec3 eyeBlock;
+    getBlockAt(eye, eyeI, eyeJ, eyeBlock);
+    world.findVisibleChunks(eyeI, eyeJ, eyeBlock.x, eyeBlock.y, eyeBlock.z, visibleChunks);
+    reachable.resize(commands.size());
+    for(size_t d = 0; d < commands.size(); d++){
+        reachable[d] = visibleChunks[chunkPositions[d * 2] * world.getSize() + chunkPositions[d * 2 + 1]];
+    }
+}
+
+void WorldRenderer::render(Shader &shader, const glm::mat4 &matrix, bool unclipped)
+{
+    auto start = std::chrono::steady_clock::now();
+    stats = WorldDrawStats();
+    if(!meshBuffer.isValid()) return;
+
+    Frustum frustum(matrix);
+    frustumVisible.clear();
+    for(size_t d = 0; d < commands.size(); d++){
+        glm::vec3 min, max;
+        getChunkBounds(chunkPositions[d * 2], chunkPositions[d * 2 + 1], chunkHeights[d], min, max);
+        if(frustumCulling && !frustum.intersectsBox(min, max)){
+            stats.chunksCulled++;
+            continue;
+        }
+        if(unclipped && connectivityCulling && !reachable[d]){
+            stats.chunksUnreachable++;
+            continue;
+        }
+        frustumVisible.push_back((int)d);
+    }
+
+    if(unclipped && occlusionCulling){
+        cullOccluded(matrix);
+    }
+    visibleCommands.clear();
+    for(int d : frustumVisible){
+        visibleCommands.push_back(commands[d]);
+    }
+    stats.chunksDrawn = (int)visibleCommands.size();
+
+    shader.use();
+    //Every chunk is a range of the same VBO, so its VAO is bound once per pass
+    worldVAO.bindVBO(meshBuffer);
+
+    if(useMultiDraw){
+        //baseInstance still indexes every chunk's position, so only the commands change per pass
+        if(positionsDirty){
+            glBindBuffer(GL_ARRAY_BUFFER, chunkBuffer);
+            glBufferData(GL_ARRAY_BUFFER, chunkPositions.size() * sizeof(GLint), chunkPositions.data(), GL_DYNAMIC_DRAW);
+            positionsDirty = false;
+        }
+        glEnableVertexAttribArray(CHUNK_ATTRIBUTE);
+        glBindBuffer(GL_DRAW_INDIRECT_BUFFER, indirectBuffer);
+        if(!visibleCommands.empty()){
+            glBufferData(GL_DRAW_INDIRECT_BUFFER, visibleCommands.size() * sizeof(DrawElementsIndirectCommand), visibleCommands.data(), GL_STREAM_DRAW);
+            multiDrawElementsIndirect(GL_TRIANGLES, GL_UNSIGNED_INT, (void*)0, (GLsizei)visibleCommands.size(), 0);
+            stats.drawCalls = 1;
+        }
+    }else{
+        //The disabled attribute reads its constant value, set per chunk
+        glDisableVertexAttribArray(CHUNK_ATTRIBUTE);
+        for(const DrawElementsIndirectCommand &command : visibleCommands){
+            glVertexAttribI4i(CHUNK_ATTRIBUTE, chunkPositions[command.baseInstance * 2], chunkPositions[command.baseInstance * 2 + 1], 0, 1);
+            glDrawElementsBaseVertex(GL_TRIANGLES, command.count, GL_UNSIGNED_INT, 0, command.baseVertex);
+        }
+        stats.drawCalls = (int)visibleCommands.size();
+    }
+
+    stats.submitTimeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+void WorldRenderer::cullOccluded(const glm::mat4 &matrix)
+{
+    //Nearest chunks first, they cover the most screen
+    occluderDistances.clear();
+    for(int d : frustumVisible){
+        glm::vec4 center = matrix * glm::vec4((float)chunkPositions[d * 2], 0.0f, (float)-chunkPositions[d * 2 + 1], 1.0f);
+        occluderDistances.push_back(std::make_pair(center.w, d));
+    }
+    size_t occluderCount = std::min(occluderDistances.size(), (size_t)OCCLUDER_CHUNKS);
+    std::partial_sort(occluderDistances.begin(), occluderDistances.begin() + occluderCount, occluderDistances.end());
+
+    culler.begin(matrix);
+    for(size_t o = 0; o < occluderCount; o++){
+        int d = occluderDistances[o].second;
+        for(int tile = 0; tile < ChunkHeights::TILES * ChunkHeights::TILES; tile++){
+            if(chunkHeights[d].solid[tile] == 0) continue;
+            glm::vec3 min, max;
+            getOccluderBounds(chunkPositions[d * 2], chunkPositions[d * 2 + 1], chunkHeights[d], tile, min, max);
+            culler.addOccluder(min, max);
+        }
+    }
+
+    size_t kept = 0;
+    for(int d : frustumVisible){
+        glm::vec3 min, max;
+        getChunkBounds(chunkPositions[d * 2], chunkPositions[d * 2 + 1], chunkHeights[d], min, max);
+        if(culler.isVisible(min, max)) frustumVisible[kept++] = d;
+    }
+    stats.chunksOccluded = (int)(frustumVisible.size() - kept);
+    frustumVisible.resize(kept);
+}
@@ -0,0 +1,131 @@
+#ifndef __WORLDRENDERER_H__
+#define __WORLDRENDERER_H__
+
+#include "Frustum.h"
+#include "OcclusionCuller.h"
+#include "Renderer.h"
+#include "World.h"
+#include <cmath>
+#include <utility>
+#include <vector>
+
+//CPU side cost of drawing the world, for the last pass
+struct WorldDrawStats {
+    int drawCalls = 0;
+    int chunksDrawn = 0;
+    int chunksCulled = 0; // outside the view frustum
+    int chunksUnreachable = 0; // inside it but not connected to the camera through air
+    int chunksOccluded = 0; // inside it but hidden behind nearer terrain
+    double submitTimeMs = 0.0; // time spent issuing the draws, not GPU time
+};
+
+//Draws every chunk range of World's mesh VBO in one glMultiDrawElementsIndirect per pass (GL 4.3).
+//Each draw's baseInstance is its index, which selects the chunk grid position from an instanced attribute
+//(location 1), so no uniform changes between chunks. Without GL 4.3 (macOS stops at 4.1) it falls back to
+//one glDrawElementsBaseVertex per chunk, setting the attribute's constant value instead.
+//Chunks outside the view frustum are skipped. Passes that draw all of the terrain also skip chunks the camera
+//cannot reach through air (World::findVisibleChunks) and chunks hidden behind the solid tiles (ChunkHeights)
+//of the nearest chunks, tested on the CPU with OcclusionCuller.
+class WorldRenderer : public Renderer {
+public:
+    //load resolves glMultiDrawElementsIndirect, which the GL 3.3 glad loader leaves out. Pass glfwGetProcAddress.
+    WorldRenderer(VertexArray &worldVAO, GLADloadproc load);
+    ~WorldRenderer();
+    WorldRenderer(const WorldRenderer &) = delete;
+    WorldRenderer &operator=(const WorldRenderer &) = delete;
+
+    bool hasMultiDrawIndirect() const { return multiDrawElementsIndirect != nullptr; }
+    bool isUsingMultiDrawIndirect() const { return useMultiDraw; }
+    //Switches between the indirect and per chunk paths, the indirect one only if supported
+    void setMultiDrawIndirect(bool enabled) { useMultiDraw = enabled && hasMultiDrawIndirect(); }
+    bool isFrustumCulling() const { return frustumCulling; }
+    void setFrustumCulling(bool enabled) { frustumCulling = enabled; }
+    bool isOcclusionCulling() const { return occlusionCulling; }
+    void setOcclusionCulling(bool enabled) { occlusionCulling = enabled; }
+    bool isConnectivityCulling() const { return connectivityCulling; }
+    void setConnectivityCulling(bool enabled) { connectivityCulling = enabled; }
+
+    //Rebuilds the draw list from the world's mesh ranges and finds the chunks reachable from eye, the camera
+    //position in the space of the shader's chunk positions. Once per frame, after World::uploadMeshes.
+    void update(const World &world, const glm::vec3 &eye);
+    //Draws the visible chunks with shader, whose uniforms are already set. matrix is projection * view * model,
+    //taking the shader's chunk positions to clip space. unclipped allows the culling that relies on all of the
+    //terrain being drawn from update's eye; leave it off when the shader clips the terrain or the view moved.
+    void render(Shader &shader, const glm::mat4 &matrix, bool unclipped);
+
+    const WorldDrawStats &getStats() const { return stats; }
+    //Occlusion culling counters and depth buffer of the last pass that used it
+    const OcclusionCuller &getOcclusionCuller() const { return culler; }
+
+    //Box of chunk (i, j) in the space of the shader's chunk positions, a unit cube centred on (i, 0, -j)
+    static void getChunkBounds(int i, int j, glm::vec3 &min, glm::vec3 &max) {
+        glm::vec3 center((float)i, 0.0f, (float)-j);
+        min = center - glm::vec3(0.5f);
+        max = center + glm::vec3(0.5f);
+    }
+    //Chunk (i, j) and block (x, y, z) in it holding position, in the space of the shader's chunk positions.
+    //The block is outside [0, CHUNK_SIZE) on y when position is above or below the chunks.
+    static void getBlockAt(const glm::vec3 &position, int &i, int &j, glm::ivec3 &block) {
+        glm::vec3 corner = position + glm::vec3(0.5f); // chunk (0, 0) spans [0, 1) from here, z growing into j = -1
+        i = (int)std::floor(corner.x);
+        j = -(int)std::floor(corner.z);
+        block.x = (int)std::floor((corner.x - i) * Chunk::CHUNK_SIZE);
+        block.y = (int)std::floor(corner.y * Chunk::CHUNK_SIZE);
+        block.z = (int)std::floor((corner.z + j) * Chunk::CHUNK_SIZE);
+    }
+    //Tighter box of chunk (i, j), from the bottom of the chunk to the top of its highest block
+    static void getChunkBounds(int i, int j, const ChunkHeights &heights, glm::vec3 &min, glm::vec3 &max) {
+        getChunkBounds(i, j, min, max);
+        max.y = min.y + (float)heights.top / Chunk::CHUNK_SIZE;
+    }
+    //Solid box under tile of chunk (i, j), empty (min.y == max.y) when the tile's bottom block is air
+    static void getOccluderBounds(int i, int j, const ChunkHeights &heights, int tile, glm::vec3 &min, glm::vec3 &max) {
+        const float tileSize = 1.0f / ChunkHeights::TILES;
+        glm::vec3 chunkMin, chunkMax;
+        getChunkBounds(i, j, chunkMin, chunkMax);
+        min = chunkMin + glm::vec3(tile % ChunkHeights::TILES * tileSize, 0.0f, tile / ChunkHeights::TILES * tileSize);
+        max = min + glm::vec3(tileSize, (float)heights.solid[tile] / Chunk::CHUNK_SIZE, tileSize);
+    }
+
+private:
+    //Layout glMultiDrawElementsIndirect reads from GL_DRAW_INDIRECT_BUFFER
+    struct DrawElementsIndirectCommand {
+        GLuint count;
+        GLuint instanceCount;
+        GLuint firstIndex;
+        GLint baseVertex;
+        GLuint baseInstance;
+    };
+    typedef void (APIENTRYP MultiDrawElementsIndirectProc)(GLenum mode, GLenum type, const void *indirect, GLsizei drawCount, GLsizei stride);
+
+    static const int CHUNK_ATTRIBUTE = 1;
+    //Nearest chunks whose solid tiles are rasterized as occluders
+    static const int OCCLUDER_CHUNKS = 16;
+
+    VertexArray &worldVAO;
+    MultiDrawElementsIndirectProc multiDrawElementsIndirect = nullptr;
+    bool useMultiDraw = false;
+    bool frustumCulling = true;
+    bool occlusionCulling = true;
+    bool connectivityCulling = true;
+    VBOHandle meshBuffer;
+
+    std::vector<DrawElementsIndirectCommand> commands; // every chunk with a mesh
+    std::vector<DrawElementsIndirectCommand> visibleCommands; // the ones drawn by the current pass
+    std::vector<GLint> chunkPositions; // grid (i, j) per command
+    std::vector<ChunkHeights> chunkHeights; // per command
+    std::vector<bool> reachable; // per command, from update's eye
+    std::vector<bool> visibleChunks; // per grid position, from World::findVisibleChunks
+    std::vector<int> frustumVisible; // commands inside the frustum, for the current pass
+    std::vector<std::pair<float, int>> occluderDistances; // (clip w, command) of frustumVisible
+    OcclusionCuller culler;
+    unsigned int indirectBuffer = 0;
+    unsigned int chunkBuffer = 0;
+    bool positionsDirty = true;
+    WorldDrawStats stats;
+
+    //Removes the chunks of frustumVisible hidden behind the solid tiles of the nearest ones
+    void cullOccluded(const glm::mat4 &matrix);
+};
+
+#endif // __WORLDRENDERER_H__
@@ -4,6 +4,7 @@
 #include <fstream>
 #include <sstream>
 #include <cmath>
+#include <memory>
 #include <random>
 #include <string>
 
@@ -13,6 +14,10 @@
 #include "VertexArray.h"
 #include "Renderer.h"
 #include "Chunk.h" 
+#include "World.h"
+#include "WorldRenderer.h"
+#include "UniformBuffer.h"
+#include "Benchmark.h"
 #include "water/WaterRenderer.h"
 #include "water/WaterFrameBuffers.h"
 
@@ -37,7 +42,7 @@ void scroll_callback(GLFWwindow* window, double xoffset, double yoffset);
 
 void processInput(GLFWwindow *window);
 
-void renderWorld(VertexArray &worldVAO, Shader worldShader, Renderer renderer, glm::mat4 &model, glm::mat4 &view, glm::mat4 &projection, glm::vec4 plane);
+WorldDrawStats renderWorld(WorldRenderer &worldRenderer, Shader &worldShader, UniformBuffer &frameUniforms, int frameSlot, glm::mat4 &view, glm::mat4 &projection, glm::vec4 plane);
 
 static void GlClearError(){
     while (glGetError() != GL_NO_ERROR);
@@ -81,9 +86,19 @@ glm::vec3 lightColor(1.0f, 1.0f, 1.0f);
 
 //World variables
 const int WORLD_SIZE = 16;
+const float WORLD_SCALE = 20.0f; //world units per chunk
+const int CAMERA_SLOT = 0; //frame uniform slots of the main camera and its reflection in the water
+const int REFLECTION_SLOT = 1;
+const ChunkStorageMode CHUNK_STORAGE_MODE = ChunkStorageMode_Palette;
 
 
-int main(){
+int main(int argc, char **argv){
+    //Run the CPU benchmarks instead of the engine
+    if(argc > 1 && std::string(argv[1]) == "--bench"){
+        runBenchmarks();
+        return 0;
+    }
+
     //Initialize GLFW and configure using Hint
     glfwInit();
     const char* glsl_version = "#version 100";
@@ -205,6 +220,8 @@ int main(){
 };
     //Parse shaders, compile, and link
     Shader worldShader("./Shaders/WorldShader.GLSL");
+    UniformBuffer frameUniforms(FRAME_BINDING, sizeof(FrameUniforms), 2);
+    worldShader.bindUniformBlock("Frame", FRAME_BINDING);
     Shader lightingShader("./Shaders/LightSourceShader.GLSL");
     lightingShader.use();
 
@@ -219,7 +236,8 @@ int main(){
     ImGui::StyleColorsDark();
 
     //Create Vertex Array
-    VertexArray worldVAO(VertexFormat_Normal_RGB_Optimized);
+    VertexArray worldVAO(VertexFormat_Packed);
+    worldVAO.createQuadIndexBuffer(World::MAX_CHUNK_QUADS);
 
 
     //Set up water
@@ -229,17 +247,21 @@ int main(){
     std::vector<WaterTile> water;
 
     //Set up world
-    std::vector<std::vector<std::unique_ptr<Chunk>>> chunks(WORLD_SIZE);
+    World world(WORLD_SIZE, CHUNK_STORAGE_MODE);
     for(int i = 0; i < WORLD_SIZE; i++){
         for(int j = 0; j < WORLD_SIZE; j++){
-            std::string key = "Chunk" + std::to_string(i) + std::to_string(j);
-            std::unique_ptr<Chunk> chunkPtr = std::make_unique<Chunk>();
-            chunks[i].push_back(std::move(chunkPtr));
-            chunks[i][j]->setupLandscape(chunks[i][j]->CHUNK_SIZE * (i + 2), chunks[i][j]->CHUNK_SIZE * (j+2));
-            worldVAO.createVBO(key, chunks[i][j]->render());
+            world.loadChunk(i, j);
             water.push_back(WaterTile(2*i,-5.9f,-2*j));
         }
      }
+    //Generate and mesh on the worker pool, then upload here on the GL thread
+    world.finishJobs();
+    world.uploadMeshes(worldVAO);
+    WorldRenderer worldRenderer(worldVAO, (GLADloadproc)glfwGetProcAddress);
+    std::cout << "World draws: " << (worldRenderer.hasMultiDrawIndirect() ? "glMultiDrawElementsIndirect" : "one draw per chunk") << "\n";
+    const MeshStats &worldMeshStats = world.getMeshStats();
+    std::cout << "World mesh: " << worldMeshStats.vertexCount << " vertices (" << worldMeshStats.naiveVertexCount << " without face culling), "
+              << worldMeshStats.vertexCount * worldVAO.getVertexSizeBytes() << " bytes of vertex data\n";
 
     //Setup a test cube
     VertexArray tv(VertexFormat_Texture);
@@ -260,7 +282,17 @@ int main(){
     float blend = 0.0;
     float fov = 45.0;
     float delay = glfwGetTime();
+    int meshMode = MeshMode_Culled;
+    const char *meshModeNames[] = {ChunkMesher::getModeName(MeshMode_Naive), ChunkMesher::getModeName(MeshMode_Culled), ChunkMesher::getModeName(MeshMode_Greedy), ChunkMesher::getModeName(MeshMode_Binary)};
     glm::vec3 waterPos(0.8f,-5.9f,-0.8f);
+    UploadStats frameUploads; //buffer uploads of the last frame
+    bool multiDrawIndirect = worldRenderer.isUsingMultiDrawIndirect();
+    bool frustumCulling = worldRenderer.isFrustumCulling();
+    bool occlusionCulling = worldRenderer.isOcclusionCulling();
+    bool connectivityCulling = worldRenderer.isConnectivityCulling();
+    WorldDrawStats worldPasses[3]; //reflection, refraction and main pass of the last frame
+    const char *worldPassNames[3] = {"reflection", "refraction", "main"};
+    VertexArray::resetUploadStats();
     glEnable(GL_DEPTH_TEST);  
 
     //Texture text1("./Textures/Bocchi2.jpeg", 0);
@@ -279,6 +311,36 @@ int main(){
             ImGui::SliderFloat3("Light Position", glm::value_ptr(lightPos), -2.0f, 2.0f);
             ImGui::SliderFloat3("Water Position", glm::value_ptr(waterPos), -2.0f, 2.0f);
             ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / ImGui::GetIO().Framerate, ImGui::GetIO().Framerate);
+            if(ImGui::Combo("Mesh Mode", &meshMode, meshModeNames, IM_ARRAYSIZE(meshModeNames))){
+                world.setMeshMode((MeshMode)meshMode);
+            }
+            ImGui::Text("World vertices: %d (%d without face culling)", worldMeshStats.vertexCount, worldMeshStats.naiveVertexCount);
+            ImGui::Text("World triangles: %d, average vertices/chunk: %d", worldMeshStats.faceCount * 2, worldMeshStats.vertexCount / (WORLD_SIZE * WORLD_SIZE));
+            ImGui::Text("World mesh time: %.2f ms", worldMeshStats.meshTimeMs);
+            HeightTileCacheStats heightCache = world.getHeightField().getCache().getStats();
+            ImGui::Text("Height tiles: %d/%d cached, %lld hits, %lld misses, %lld evicted", heightCache.tiles, heightCache.capacity, heightCache.hits, heightCache.misses, heightCache.evictions);
+            ImGui::Text("Uploads: %zu bytes/frame, %d sub data, %d allocations", frameUploads.bytesUploaded, frameUploads.subDataUploads, frameUploads.allocations);
+            AllocatorStats meshBuffer = world.getMeshBufferStats();
+            ImGui::Text("Mesh buffer: %d/%d vertices used, high water %d", meshBuffer.used, meshBuffer.capacity, meshBuffer.highWaterMark);
+            ImGui::Text("Mesh buffer: %d ranges, %d free ranges, %.1f%% fragmented", meshBuffer.allocations, meshBuffer.freeBlocks, meshBuffer.fragmentation * 100.0f);
+            if(ImGui::Checkbox("Multi draw indirect", &multiDrawIndirect)){
+                worldRenderer.setMultiDrawIndirect(multiDrawIndirect);
+                multiDrawIndirect = worldRenderer.isUsingMultiDrawIndirect();
+            }
+            if(ImGui::Checkbox("Frustum culling", &frustumCulling)){
+                worldRenderer.setFrustumCulling(frustumCulling);
+            }
+            if(ImGui::Checkbox("Occlusion culling", &occlusionCulling)){
+                worldRenderer.setOcclusionCulling(occlusionCulling);
+            }
+            if(ImGui::Checkbox("Connectivity culling", &connectivityCulling)){
+                worldRenderer.setConnectivityCulling(connectivityCulling);
+            }
+            for(int pass = 0; pass < 3; pass++){
+                ImGui::Text("World %s pass: %d chunks drawn, %d culled, %d unreachable, %d occluded, %d calls, %.3f ms to submit", worldPassNames[pass],
+                            worldPasses[pass].chunksDrawn, worldPasses[pass].chunksCulled, worldPasses[pass].chunksUnreachable,
+                            worldPasses[pass].chunksOccluded, worldPasses[pass].drawCalls, worldPasses[pass].submitTimeMs);
+            }
         }   
         
         //Input
@@ -296,28 +358,42 @@ int main(){
         deltaTime = currentTime - lastFrame;
         lastFrame = currentTime;
 
+        //Pick up chunks the workers finished and re-mesh changed ones in the background
+        world.processJobs();
+        world.uploadMeshes(worldVAO);
+        worldRenderer.update(world, camera.Position / WORLD_SCALE);
+        frameUploads = VertexArray::getUploadStats();
+        VertexArray::resetUploadStats();
+
         //Init transformation matrices
-        glm::mat4 model = glm::mat4(1.0f);
         glm::mat4 view = camera.GetViewMatrix();
         glm::mat4 projection = glm::mat4(1.0f);
         projection = glm::perspective(glm::radians(camera.Zoom), 800.0f / 600.0f, 0.1f, 200.0f);
 
-        //Render for fbo
-        fbos.bindReflectionFrameBuffer();
+        //Per frame uniforms of both views, sent in one upload. The reflection mirrors the camera in the water.
         float distance = 2 * (camera.Position.y + 5.9);
         camera.Position.y -= distance;
         camera.invertPitch();
         glm::mat4 reflectionView = camera.GetViewMatrix();
-        renderWorld(worldVAO, worldShader, renderer, model, reflectionView, projection, glm::vec4(0,1,0, 5.9));
+        FrameUniforms frame = {reflectionView, projection, glm::vec4(camera.Position, 1.0f), glm::vec4(lightPos, 1.0f), glm::vec4(lightColor, 1.0f)};
+        frameUniforms.setSlot(REFLECTION_SLOT, frame);
         camera.Position.y += distance;
         camera.invertPitch();
+        frame.view = view;
+        frame.cameraPosition = glm::vec4(camera.Position, 1.0f);
+        frameUniforms.setSlot(CAMERA_SLOT, frame);
+        frameUniforms.upload();
+
+        fbos.bindReflectionFrameBuffer();
+        worldPasses[0] = renderWorld(worldRenderer, worldShader, frameUniforms, REFLECTION_SLOT, reflectionView, projection, glm::vec4(0,1,0, 5.9));
         fbos.bindRefractionFrameBuffer();
-        renderWorld(worldVAO, worldShader, renderer, model, view, projection, glm::vec4(0,-1,0,-5.9));
+        worldPasses[1] = renderWorld(worldRenderer, worldShader, frameUniforms, CAMERA_SLOT, view, projection, glm::vec4(0,-1,0,-5.9));
         fbos.unbindCurrentFrameBuffer();
 
-        //Render Lighting
+        //Render Lighting, a small cube at the light's world position
         lightingShader.use();
         lightVAO.bind();
+        glm::mat4 model = glm::mat4(1.0f);
         model = glm::translate(model, lightPos);
         model = glm::scale(model, glm::vec3(0.2f)); 
         lightingShader.setMat4("model", model);
@@ -354,10 +430,10 @@ int main(){
 
         //GenerateWorld
         glDisable(GL_CLIP_DISTANCE0);
-        renderWorld(worldVAO, worldShader, renderer, model, view, projection, glm::vec4(0,0,0,0));
+        worldPasses[2] = renderWorld(worldRenderer, worldShader, frameUniforms, CAMERA_SLOT, view, projection, glm::vec4(0,0,0,0));
 
-        //Render Water
-        waterRenderer.render(water, camera, projection);
+        //Render Water, the Frame block is still bound to the camera's slot
+        waterRenderer.render(water);
 
         //Rendering
         ImGui::Render();
@@ -376,30 +452,22 @@ int main(){
     return 0;
 }
  
-void renderWorld(VertexArray &worldVAO, Shader worldShader, Renderer renderer, glm::mat4 &model, glm::mat4 &view, glm::mat4 &projection, glm::vec4 plane)  {
-    worldVAO.bind();
+WorldDrawStats renderWorld(WorldRenderer &worldRenderer, Shader &worldShader, UniformBuffer &frameUniforms, int frameSlot, glm::mat4 &view, glm::mat4 &projection, glm::vec4 plane)  {
+    //View, projection, camera and light come from the Frame block, view and projection are only needed here to cull
+    frameUniforms.bindSlot(frameSlot);
     worldShader.use();
     worldShader.setVec4("plane", plane);
-    worldShader.setMat4("view", view);
-    worldShader.setMat4("projection", projection);
-    worldShader.setVec3("lightPos", lightPos);  
-    worldShader.setVec3("lightColor",  lightColor);
-    worldShader.setVec3("viewPos", camera.Position);
-    for(int i = 0; i < WORLD_SIZE; i++){
-        for(int j = 0; j < WORLD_SIZE; j++){
-            std::string key = "Chunk" + std::to_string(i) + std::to_string(j);
-            worldVAO.bindVBO(key);
-
-            //Draw Object
-            model = glm::mat4(1.0f);
 
-            model = glm::scale(model, glm::vec3(20,20,20));
-            model = glm::translate(model, glm::vec3(i ,0.0f,-j));
-            worldShader.setMat4("model", model); 
+    //Chunks add their grid position in the shader, so the model matrix only scales the world
+    glm::mat4 model = glm::mat4(1.0f);
+    model = glm::scale(model, glm::vec3(WORLD_SCALE));
+    worldShader.setMat4("model", model); 
 
-            renderer.draw(worldVAO, worldShader);
-         }
-    }
+    //Culls in the space of the chunk positions, the mirrored view culls for the reflection.
+    //Only the unclipped main pass can use the terrain as occluders and the camera's connectivity.
+    bool unclipped = plane == glm::vec4(0.0f);
+    worldRenderer.render(worldShader, projection * view * model, unclipped);
+    return worldRenderer.getStats();
 }
 
 //Takes in window, and new width and height. Changes viewport on resize
@@ -20,12 +20,18 @@
 // off every 'zig'.)
 //
 
+#include <algorithm>
+#include <condition_variable>
 #include <fstream>
+#include <memory>
+#include <mutex>
+#include <vector>
 
 #include <noise/interp.h>
 #include <noise/mathconsts.h>
 
 #include "noiseutils.h"
+#include "ThreadPool.h"
 
 using namespace noise;
 using namespace noise::model;
@@ -827,10 +833,38 @@ NoiseMapBuilderPlane::NoiseMapBuilderPlane ():
   m_lowerXBound  (0.0),
   m_lowerZBound  (0.0),
   m_upperXBound  (0.0),
-  m_upperZBound  (0.0)
+  m_upperZBound  (0.0),
+  m_pThreadPool  (NULL)
 {
 }
 
+// Progress of a NoiseMapBuilderPlane::Build () on a thread pool.  Owned
+// together by the build and its jobs, as a job can start after the calling
+// thread already filled every row and returned.
+struct PlaneBuildRows
+{
+  std::mutex mutex;
+  std::condition_variable rowDone;
+  int nextRow = 0;
+  std::vector<bool> isRowDone;
+
+  // Returns the next row nobody has started, or -1 when there is none.
+  int TakeRow (int rowCount)
+  {
+    std::lock_guard<std::mutex> lock (mutex);
+    return nextRow < rowCount ? nextRow++ : -1;
+  }
+
+  void FinishRow (int z)
+  {
+    {
+      std::lock_guard<std::mutex> lock (mutex);
+      isRowDone[z] = true;
+    }
+    rowDone.notify_all ();
+  }
+};
+
 void NoiseMapBuilderPlane::Build ()
 {
   if ( m_upperXBound <= m_lowerXBound
@@ -854,14 +888,29 @@ void NoiseMapBuilderPlane::Build ()
   double zExtent = m_upperZBound - m_lowerZBound;
   double xDelta  = xExtent / (double)m_destWidth ;
   double zDelta  = zExtent / (double)m_destHeight;
-  double xCur    = m_lowerXBound;
-  double zCur    = m_lowerZBound;
 
-  // Fill every point in the noise map with the output values from the model.
+  // The coordinates of every column and row, added up one step at a time
+  // as a single thread walking the map would, so that any row can be
+  // filled on its own with the same values.
+  std::vector<double> xCoords (m_destWidth);
+  std::vector<double> zCoords (m_destHeight);
+  double xSum = m_lowerXBound;
+  for (int x = 0; x < m_destWidth; x++) {
+    xCoords[x] = xSum;
+    xSum += xDelta;
+  }
+  double zSum = m_lowerZBound;
   for (int z = 0; z < m_destHeight; z++) {
+    zCoords[z] = zSum;
+    zSum += zDelta;
+  }
+
+  // Fills row z of the noise map with the output values from the model.
+  auto fillRow = [&] (int z) {
     float* pDest = m_pDestNoiseMap->GetSlabPtr (z);
-    xCur = m_lowerXBound;
+    double zCur = zCoords[z];
     for (int x = 0; x < m_destWidth; x++) {
+      double xCur = xCoords[x];
       float finalValue;
       if (!m_isSeamlessEnabled) {
         finalValue = planeModel.GetValue (xCur, zCur);
@@ -878,13 +927,66 @@ void NoiseMapBuilderPlane::Build ()
         finalValue = (float)LinearInterp (z0, z1, zBlend);
       }
       *pDest++ = finalValue;
-      xCur += xDelta;
     }
-    zCur += zDelta;
-    if (m_pCallback != NULL) {
-      m_pCallback (z);
+  };
+
+  int helperCount = m_pThreadPool != NULL ?
+    std::min (m_pThreadPool->getThreadCount (), m_destHeight - 1) : 0;
+  if (helperCount <= 0) {
+    for (int z = 0; z < m_destHeight; z++) {
+      fillRow (z);
+      if (m_pCallback != NULL) {
+        m_pCallback (z);
+      }
     }
+    return;
+  }
+
+  // Fill the rows on the pool and this thread, each thread taking the next
+  // row nobody has started.  A job only touches this builder after taking a
+  // row, and this thread waits for every taken row to be finished.
+  int rowCount = m_destHeight;
+  std::shared_ptr<PlaneBuildRows> pRows = std::make_shared<PlaneBuildRows> ();
+  pRows->isRowDone.assign (rowCount, false);
+  for (int i = 0; i < helperCount; i++) {
+    m_pThreadPool->submit ([pRows, rowCount, &fillRow] {
+      int z;
+      while ((z = pRows->TakeRow (rowCount)) != -1) {
+        fillRow (z);
+        pRows->FinishRow (z);
+      }
+    });
+  }
+
+  // Rows can finish in any order, the callback is called for each one
+  // only once every row before it is done.
+  int reportedRows = 0;
+  auto reportRows = [&] (bool wait) {
+    std::unique_lock<std::mutex> lock (pRows->mutex);
+    while (reportedRows < rowCount) {
+      if (!pRows->isRowDone[reportedRows]) {
+        if (!wait) {
+          return;
+        }
+        pRows->rowDone.wait (lock);
+        continue;
+      }
+      if (m_pCallback != NULL) {
+        lock.unlock ();
+        m_pCallback (reportedRows);
+        lock.lock ();
+      }
+      reportedRows++;
+    }
+  };
+
+  int z;
+  while ((z = pRows->TakeRow (rowCount)) != -1) {
+    fillRow (z);
+    pRows->FinishRow (z);
+    reportRows (false);
   }
+  reportRows (true);
 }
 
 /////////////////////////////////////////////////////////////////////////////
@@ -29,6 +29,8 @@
 
 #include <noise/noise.h>
 
+class ThreadPool;
+
 using namespace noise;
 
 namespace noise
@@ -1607,6 +1609,23 @@ namespace noise
 
         virtual void Build ();
 
+        /// Sets the thread pool that helps fill the rows of the noise map.
+        ///
+        /// @param pThreadPool The pool, or NULL to build on the calling
+        /// thread only.
+        ///
+        /// The calling thread fills rows too, so Build() may be called from
+        /// a job of the same pool.  The noise map is identical to the one a
+        /// single thread builds, and the callback function is still called
+        /// once per row, in row order, on the calling thread.
+        ///
+        /// The source module must support calls from several threads at
+        /// once, which the modules that only hold parameters do.
+        void SetThreadPool (ThreadPool* pThreadPool)
+        {
+          m_pThreadPool = pThreadPool;
+        }
+
         /// Enables or disables seamless tiling.
         ///
         /// @param enable A flag that enables or disables seamless tiling.
@@ -1709,6 +1728,9 @@ namespace noise
         /// Upper z boundary of the planar noise map, in units.
         double m_upperZBound;
 
+        /// Pool that helps fill the rows, or NULL.
+        ThreadPool* m_pThreadPool;
+
     };
 
 
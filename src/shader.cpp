@@ -1,5 +1,4 @@
 #include "Shader.h"
-#include <stdlib.h>
 
 //Helper Functions
 static ShaderProgramSource parseShader(const std::string filePath){
@@ -55,9 +54,9 @@ static unsigned int compileAndLinkShaders(ShaderProgramSource shaderSource){
         std::cout << "ERROR::SHADER::VERTEX::COMPILATION_FAILED\n" << infoLog << std::endl;
     }
 
-    glGetProgramiv(fragmentShader, GL_COMPILE_STATUS, &success);
+    glGetShaderiv(fragmentShader, GL_COMPILE_STATUS, &success);
     if(!success) {
-        glGetProgramInfoLog(fragmentShader, 512, NULL, infoLog);
+        glGetShaderInfoLog(fragmentShader, 512, NULL, infoLog);
         std::cout << "ERROR::SHADER::FRAGMENT::COMPILATION_FAILED\n" << infoLog << std::endl;
     }
 
@@ -89,84 +88,74 @@ Shader::Shader(const std::string filePath){
     unsigned int shaderProgram = compileAndLinkShaders(shaderSource);
     ID = shaderProgram;
     glUseProgram(ID);
+
+    //Look every uniform up once, the setters only search this table
+    int uniformCount = 0;
+    glGetProgramiv(ID, GL_ACTIVE_UNIFORMS, &uniformCount);
+    for(int u = 0; u < uniformCount; u++){
+        char name[256];
+        GLsizei length = 0;
+        GLint size = 0;
+        GLenum type = 0;
+        glGetActiveUniform(ID, u, sizeof(name), &length, &size, &type, name);
+        //Members of uniform blocks have no location
+        int location = glGetUniformLocation(ID, name);
+        if(location == -1) continue;
+
+        std::string uniformName(name, length);
+        uniformLocations[uniformName] = location;
+        //Arrays are listed as name[0], also accept name
+        if(uniformName.size() > 3 && uniformName.compare(uniformName.size() - 3, 3, "[0]") == 0){
+            uniformLocations[uniformName.substr(0, uniformName.size() - 3)] = location;
+        }
+    }
 }
 
 void Shader::use() {
     glUseProgram(ID);
 }
 
-void Shader::setBool(const std::string &name, bool value) const {
-    int uniformLocation = glGetUniformLocation(ID, name.c_str());
-    if(uniformLocation == -1){
-        std::cout << "ERROR::SHADER::SETBOOL::UNIFORM_LOCATION_FAILED" << std::endl;
-        exit(0);
-    }
+int Shader::getUniformLocation(const std::string &name) const {
+    auto found = uniformLocations.find(name);
+    if(found != uniformLocations.end()) return found->second;
 
-    //Update Uniform value
-    glUniform1i(uniformLocation, (int)value);
-}  
+    //Not in the program, or optimised out. Remember the miss so it is only reported once.
+    std::cout << "ERROR::SHADER::UNIFORM_LOCATION_FAILED: uniform " << name << " was not found." << std::endl;
+    uniformLocations[name] = -1;
+    return -1;
+}
 
-void Shader::setInt(const std::string &name, int value) const {
-    int uniformLocation = glGetUniformLocation(ID, name.c_str());
-    if(uniformLocation == -1){
-        std::cout << "ERROR::SHADER::SETINT::UNIFORM_LOCATION_FAILED" << std::endl;
-        exit(0);
+void Shader::bindUniformBlock(const std::string &name, unsigned int bindingPoint) const {
+    unsigned int blockIndex = glGetUniformBlockIndex(ID, name.c_str());
+    if(blockIndex == GL_INVALID_INDEX){
+        std::cout << "ERROR::SHADER::UNIFORM_BLOCK_FAILED: uniform block " << name << " was not found." << std::endl;
+        return;
     }
+    glUniformBlockBinding(ID, blockIndex, bindingPoint);
+}
 
-    //Update Uniform value
-    glUniform1i(uniformLocation, value);
-}   
+void Shader::setBool(const std::string &name, bool value) const {
+    glUniform1i(getUniformLocation(name), (int)value);
+}
 
-void Shader::setFloat(const std::string &name, float value) const {
-    int uniformLocation = glGetUniformLocation(ID, name.c_str());
-    if(uniformLocation == -1){
-        std::cout << "ERROR::SHADER::SETFLOAT::UNIFORM_LOCATION_FAILED" << std::endl;
-        exit(0);
-    }
+void Shader::setInt(const std::string &name, int value) const {
+    glUniform1i(getUniformLocation(name), value);
+}
 
-    //Update Uniform value
-    glUniform1f(uniformLocation, value);
+void Shader::setFloat(const std::string &name, float value) const {
+    glUniform1f(getUniformLocation(name), value);
 }
 
 void Shader::setMat4(const std::string &name, glm::mat4 matrix) const {
-    int uniformLocation = glGetUniformLocation(ID, name.c_str());
-    if(uniformLocation == -1){
-        std::cout << "ERROR::SHADER::SETMATRIX::UNIFORM_LOCATION_FAILED" << std::endl;
-        std::cout << "ERROR: uniform location at " << name << " was not founded." << std::endl;
-        exit(0);
-    }
-
-    //Update Uniform value
-    glUniformMatrix4fv(uniformLocation, 1, GL_FALSE, glm::value_ptr(matrix));
+    glUniformMatrix4fv(getUniformLocation(name), 1, GL_FALSE, glm::value_ptr(matrix));
 }
 
 void Shader::setVec3(const std::string &name, glm::vec3 vec3) const
 {
-    int uniformLocation = glGetUniformLocation(ID, name.c_str());
-    if(uniformLocation == -1){
-        std::cout << "ERROR::SHADER::SETVEC3::UNIFORM_LOCATION_FAILED" << std::endl;
-        std::cout << "ERROR: uniform location at " << name << " was not founded." << std::endl;
-        exit(0);
-    }
-    
-    //Update Uniform value
-    glUniform3f(uniformLocation, vec3.x, vec3.y, vec3.z);
+    glUniform3f(getUniformLocation(name), vec3.x, vec3.y, vec3.z);
 }
 
 void Shader::setVec4(const std::string &name, glm::vec4 vec4) const
 {
-    int uniformLocation = glGetUniformLocation(ID, name.c_str());
-    if(uniformLocation == -1){
-        std::cout << "ERROR::SHADER::SETVEC3::UNIFORM_LOCATION_FAILED" << std::endl;
-        std::cout << "ERROR: uniform location at " << name << " was not founded." << std::endl;
-        exit(0);
-    }
-    
-    //Update Uniform value
-    glUniform4f(uniformLocation, vec4.x, vec4.y, vec4.z, vec4.w);
+    glUniform4f(getUniformLocation(name), vec4.x, vec4.y, vec4.z, vec4.w);
 }
-
-
-
-
-
@@ -6,12 +6,12 @@ WaterRenderer::WaterRenderer(WaterShader shader, WaterFrameBuffers fbos)
     this->shader = shader;
     this->fbos = fbos;
     //prepare VAO
-    waterVAO.createVBO("water", { -1, -1, -1, 1, 1, -1, 1, -1, -1, 1, 1, 1 });
+    waterVAO.createVBO("water", std::vector<float>{ -1, -1, -1, 1, 1, -1, 1, -1, -1, 1, 1, 1 });
 }
 
-void WaterRenderer::render(std::vector<WaterTile> water, Camera camera, glm::mat4 projection)
+void WaterRenderer::render(std::vector<WaterTile> water)
 {   
-    prepareRender(camera, projection);
+    prepareRender();
     waterVAO.bind();
     waterVAO.bindVBO("water");
     for(WaterTile tile : water){
@@ -23,16 +23,9 @@ void WaterRenderer::render(std::vector<WaterTile> water, Camera camera, glm::mat
         draw(waterVAO,shader);
     }
 }
-void WaterRenderer::prepareRender(Camera camera, glm::mat4 projection)
+void WaterRenderer::prepareRender()
 {
-    glm::vec3 lightPos(10.0f, 10.0f, -10.0f);
-    glm::vec3 lightColor(1.0f, 1.0f, 1.0f);
-    glm::mat4 view = camera.GetViewMatrix();
     shader.use();
-    shader.loadViewMatrix(view);
-    shader.loadProjectionMatrix(projection);
-    shader.loadCameraPosition(camera.Position);
-    shader.loadLight(lightPos, lightColor); 
     moveFactor = WAVE_SPEED * glfwGetTime();
     moveFactor = fmod(moveFactor, 1.0f);
     shader.loadMoveFactor(moveFactor);
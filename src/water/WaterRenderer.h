@@ -7,7 +7,6 @@
 #include "../Texture.h"
 #include "../VertexArray.h"
 #include "../Renderer.h"
-#include "../Camera.h"
 #include <vector>
 #include <glad/glad.h>
 #include <GLFW/glfw3.h>
@@ -22,11 +21,11 @@ class WaterRenderer  : public Renderer {
     Texture waterDudvMap = Texture( "Textures/waterdudv.png", 2);
     Texture normalMap = Texture( "Textures/NormalMap.png", 3);
 
-    void prepareRender(Camera camera, glm::mat4 projection);
+    void prepareRender();
 
 public:
     WaterRenderer(WaterShader shader, WaterFrameBuffers fbos);
-    void render(std::vector<WaterTile> water, Camera camera, glm::mat4 projection);
+    void render(std::vector<WaterTile> water);
 
 };
 #endif // __WATERRENDERER_H__
\ No newline at end of file
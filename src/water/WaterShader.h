@@ -2,6 +2,7 @@
 #define __WATERSHADER_H__
 
 #include "../Shader.h"
+#include "../UniformBuffer.h"
 #include <string>
 
 static const std::string SHADER_FILE = "Shaders/WaterShader.GLSL";
@@ -10,16 +11,11 @@ static const std::string SHADER_FILE = "Shaders/WaterShader.GLSL";
 class WaterShader : public Shader {
     
 public:
-    WaterShader() : Shader(SHADER_FILE){};
+    //View, projection, camera and light are read from the Frame uniform block
+    WaterShader() : Shader(SHADER_FILE){
+        bindUniformBlock("Frame", FRAME_BINDING);
+    };
 
-    void loadProjectionMatrix(glm::mat4 projection){
-        setMat4("projection", projection);
-    }
-    
-    void loadViewMatrix(glm::mat4 view){
-        setMat4("view", view);
-    }
-    
     void loadModelMatrix(glm::mat4 model){
         setMat4("model", model);
     }
@@ -28,16 +24,6 @@ public:
         setFloat("moveFactor", moveFactor);
     }
 
-    void loadCameraPosition(glm::vec3 cameraPosition){
-        setVec3("cameraPosition", cameraPosition);
-    }
-
-    void loadLight(glm::vec3 lightPosition, glm::vec3 lightColor){
-        setVec3("lightPosition", lightPosition);
-        setVec3("lightColor", lightColor);
-
-    }
-    
     void connectTextureUnits(){
         setInt("reflectionTexture", 0);
         setInt("refractionTexture", 1);
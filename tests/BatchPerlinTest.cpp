@@ -0,0 +1,116 @@
+#include "Tests.h"
+#include "BatchPerlin.h"
+
+#include <algorithm>
+#include <cmath>
+#include <random>
+#include <vector>
+
+//Largest difference from libnoise seen at |x|, |z| <= 4096 is about 4.5e-5, from float rounding
+static const double TOLERANCE = 1e-4;
+
+static const noise::NoiseQuality QUALITIES[] = {noise::QUALITY_FAST, noise::QUALITY_STD, noise::QUALITY_BEST};
+
+//BatchPerlin's values at the points against module::Perlin sampled through model::Plane, as height maps do
+static double getMaxDifference(const noise::module::Perlin &perlin, const std::vector<float> &xs, const std::vector<float> &zs)
+{
+    BatchPerlin batch(perlin);
+    noise::model::Plane plane(perlin);
+    std::vector<float> values(xs.size());
+    batch.getValues(xs.data(), zs.data(), (int)xs.size(), values.data());
+
+    double maxDifference = 0.0;
+    for(size_t k = 0; k < xs.size(); k++){
+        maxDifference = std::max(maxDifference, std::abs(plane.GetValue(xs[k], zs[k]) - values[k]));
+        maxDifference = std::max(maxDifference, std::abs(plane.GetValue(xs[k], zs[k]) - batch.getValue(xs[k], zs[k])));
+    }
+    return maxDifference;
+}
+
+//The terrain's parameters, frequency 0.01
+static noise::module::Perlin getTerrainPerlin(noise::NoiseQuality quality)
+{
+    noise::module::Perlin perlin;
+    perlin.SetFrequency(0.01);
+    perlin.SetNoiseQuality(quality);
+    return perlin;
+}
+
+static void testRandomPoints()
+{
+    const int POINT_COUNT = 4096;
+    std::mt19937 random(5);
+    std::uniform_real_distribution<float> coordinate(-4096.0f, 4096.0f), negative(-4096.0f, -0.001f);
+    std::vector<float> xs(POINT_COUNT), zs(POINT_COUNT), negativeXs(POINT_COUNT), negativeZs(POINT_COUNT);
+    for(int k = 0; k < POINT_COUNT; k++){
+        xs[k] = coordinate(random);
+        zs[k] = coordinate(random);
+        negativeXs[k] = negative(random);
+        negativeZs[k] = negative(random);
+    }
+
+    for(noise::NoiseQuality quality : QUALITIES){
+        noise::module::Perlin perlin = getTerrainPerlin(quality);
+        CHECK(getMaxDifference(perlin, xs, zs) < TOLERANCE);
+        CHECK(getMaxDifference(perlin, negativeXs, negativeZs) < TOLERANCE);
+
+        //Other parameters than the defaults
+        perlin.SetSeed(1234);
+        perlin.SetOctaveCount(8);
+        perlin.SetLacunarity(2.5);
+        perlin.SetPersistence(0.4);
+        CHECK(getMaxDifference(perlin, xs, zs) < TOLERANCE);
+    }
+}
+
+static void testLatticePoints()
+{
+    //With frequency 1 and lacunarity 2 integer points stay on the lattice in every octave, where gradient noise is 0
+    std::vector<float> xs, zs;
+    for(int x = -40; x <= 40; x += 3){
+        for(int z = -40; z <= 40; z += 5){
+            xs.push_back((float)x);
+            zs.push_back((float)z);
+        }
+    }
+    for(noise::NoiseQuality quality : QUALITIES){
+        noise::module::Perlin perlin;
+        perlin.SetFrequency(1.0);
+        perlin.SetNoiseQuality(quality);
+        CHECK(getMaxDifference(perlin, xs, zs) < TOLERANCE);
+
+        BatchPerlin batch(perlin);
+        std::vector<float> values(xs.size());
+        batch.getValues(xs.data(), zs.data(), (int)xs.size(), values.data());
+        CHECK(*std::max_element(values.begin(), values.end()) < TOLERANCE);
+        CHECK(*std::min_element(values.begin(), values.end()) > -TOLERANCE);
+
+        //The integer grid the height field samples, on and off the terrain's lattice
+        CHECK(getMaxDifference(getTerrainPerlin(quality), xs, zs) < TOLERANCE);
+    }
+}
+
+static void testBatchTails()
+{
+    //Counts that leave 1 .. getBatchSize() - 1 points for the scalar path, and fewer points than one batch
+    std::mt19937 random(9);
+    std::uniform_real_distribution<float> coordinate(-300.0f, 300.0f);
+    for(int count = 1; count <= 3 * BatchPerlin::getBatchSize() + 1; count++){
+        std::vector<float> xs(count), zs(count);
+        for(int k = 0; k < count; k++){
+            xs[k] = coordinate(random);
+            zs[k] = coordinate(random);
+        }
+        for(noise::NoiseQuality quality : QUALITIES){
+            CHECK(getMaxDifference(getTerrainPerlin(quality), xs, zs) < TOLERANCE);
+        }
+    }
+}
+
+void runBatchPerlinTests()
+{
+    std::cout << "BatchPerlin: " << BatchPerlin::getInstructionSetName() << " path, " << BatchPerlin::getBatchSize() << " points per batch\n";
+    testRandomPoints();
+    testLatticePoints();
+    testBatchTails();
+}
@@ -0,0 +1,303 @@
+#include "Tests.h"
+#include "ChunkConnectivity.h"
+#include "World.h"
+
+#include <random>
+#include <vector>
+
+static const int CHUNK_SIZE = ChunkStorage::CHUNK_SIZE;
+static const int LAST = CHUNK_SIZE - 1;
+
+static uint32_t getOpeningBit(ChunkSide side, int y)
+{
+    return 1u << ChunkConnectivity::getOpening(side, y);
+}
+
+static bool isSame(const ChunkConnectivity &a, const ChunkConnectivity &b)
+{
+    for(int opening = 0; opening < ChunkConnectivity::OPENING_COUNT; opening++){
+        if(a.getConnected(opening) != b.getConnected(opening)) return false;
+    }
+    return true;
+}
+
+static ChunkStorage makeSolid(ChunkStorageMode mode = ChunkStorageMode_Flat)
+{
+    ChunkStorage blocks(mode);
+    blocks.fill(toBlockId(BlockType_Stone));
+    return blocks;
+}
+
+//Blocks of the box from (x0, y0, z0) to (x1, y1, z1), both included, set to id
+static void fillBox(ChunkStorage &blocks, int x0, int y0, int z0, int x1, int y1, int z1, BlockId id = BlockId_Air)
+{
+    for(int x = x0; x <= x1; x++){
+        for(int y = y0; y <= y1; y++){
+            for(int z = z0; z <= z1; z++){
+                blocks.set(x, y, z, id);
+            }
+        }
+    }
+}
+
+//The same box through World, so the chunk and its mesh see the edit
+static void fillBox(World &world, int i, int j, int x0, int y0, int z0, int x1, int y1, int z1, bool solid)
+{
+    for(int x = x0; x <= x1; x++){
+        for(int y = y0; y <= y1; y++){
+            for(int z = z0; z <= z1; z++){
+                if(solid) world.setBlock(i, j, x, y, z, BlockType_Stone);
+                else world.removeBlock(i, j, x, y, z);
+            }
+        }
+    }
+}
+
+//Block by block flood fill of every air pocket, the openings each touches joined pairwise
+static void getReferenceConnected(const ChunkStorage &blocks, uint32_t connected[ChunkConnectivity::OPENING_COUNT])
+{
+    struct Position {
+        int x, y, z;
+    };
+    std::vector<bool> visited(ChunkStorage::CHUNK_VOLUME, false);
+    for(int opening = 0; opening < ChunkConnectivity::OPENING_COUNT; opening++) connected[opening] = 0;
+
+    for(int start = 0; start < ChunkStorage::CHUNK_VOLUME; start++){
+        Position first = {start / ChunkStorage::CHUNK_AREA, start % CHUNK_SIZE, start / CHUNK_SIZE % CHUNK_SIZE};
+        if(visited[start] || blocks.isActive(first.x, first.y, first.z)) continue;
+        visited[start] = true;
+        std::vector<Position> stack = {first};
+        uint32_t touched = 0;
+        while(!stack.empty()){
+            Position p = stack.back();
+            stack.pop_back();
+            if(p.z == 0) touched |= getOpeningBit(ChunkSide_NegZ, p.y);
+            if(p.z == LAST) touched |= getOpeningBit(ChunkSide_PosZ, p.y);
+            if(p.x == 0) touched |= getOpeningBit(ChunkSide_NegX, p.y);
+            if(p.x == LAST) touched |= getOpeningBit(ChunkSide_PosX, p.y);
+            if(p.y == 0) touched |= 1u << ChunkConnectivity::BOTTOM;
+            if(p.y == LAST) touched |= 1u << ChunkConnectivity::TOP;
+
+            const int offsets[6][3] = {{1, 0, 0}, {-1, 0, 0}, {0, 1, 0}, {0, -1, 0}, {0, 0, 1}, {0, 0, -1}};
+            for(const int *offset : offsets){
+                Position n = {p.x + offset[0], p.y + offset[1], p.z + offset[2]};
+                if(n.x < 0 || n.x > LAST || n.y < 0 || n.y > LAST || n.z < 0 || n.z > LAST) continue;
+                int index = ChunkStorage::index(n.x, n.y, n.z);
+                if(visited[index] || blocks.isActive(n.x, n.y, n.z)) continue;
+                visited[index] = true;
+                stack.push_back(n);
+            }
+        }
+        for(int opening = 0; opening < ChunkConnectivity::OPENING_COUNT; opening++){
+            if(touched & (1u << opening)) connected[opening] |= touched;
+        }
+    }
+}
+
+static void testUniformChunks()
+{
+    for(ChunkStorageMode mode : {ChunkStorageMode_Flat, ChunkStorageMode_Palette}){
+        ChunkStorage air(mode);
+        air.fill(BlockId_Air);
+        ChunkConnectivity open = ChunkConnectivity::compute(air);
+        ChunkConnectivity closed = ChunkConnectivity::compute(makeSolid(mode));
+        for(int opening = 0; opening < ChunkConnectivity::OPENING_COUNT; opening++){
+            CHECK(open.getConnected(opening) == ChunkConnectivity::ALL_OPENINGS);
+            CHECK(closed.getConnected(opening) == 0);
+        }
+        CHECK(ChunkConnectivity::getReachableOpenings(air, 3, 17, 29) == ChunkConnectivity::ALL_OPENINGS);
+        CHECK(ChunkConnectivity::getReachableOpenings(makeSolid(mode), 3, 17, 29) == 0);
+    }
+}
+
+//A tunnel in the bottom band, under solid ground with air above it, stays apart from the surface
+static void testSealedTunnel()
+{
+    const int SURFACE = 3 * ChunkConnectivity::BAND_HEIGHT;
+    ChunkStorage blocks = makeSolid();
+    fillBox(blocks, 0, SURFACE, 0, LAST, LAST, LAST);
+    fillBox(blocks, 0, 4, 10, LAST, 5, 11);
+
+    uint32_t tunnel = getOpeningBit(ChunkSide_NegX, 4) | getOpeningBit(ChunkSide_PosX, 4);
+    uint32_t surface = 1u << ChunkConnectivity::TOP;
+    for(ChunkSide side : {ChunkSide_NegZ, ChunkSide_PosZ, ChunkSide_NegX, ChunkSide_PosX}){
+        surface |= getOpeningBit(side, SURFACE);
+    }
+    ChunkConnectivity connectivity = ChunkConnectivity::compute(blocks);
+    CHECK(connectivity.getConnected(ChunkConnectivity::getOpening(ChunkSide_NegX, 4)) == tunnel);
+    CHECK(connectivity.getConnected(ChunkConnectivity::getOpening(ChunkSide_PosX, 5)) == tunnel);
+    CHECK(connectivity.getConnected(ChunkConnectivity::TOP) == surface);
+    CHECK(connectivity.getConnected(ChunkConnectivity::BOTTOM) == 0);
+    CHECK(connectivity.getConnected(ChunkConnectivity::getOpening(ChunkSide_NegZ, 4)) == 0);
+    CHECK(ChunkConnectivity::getReachableOpenings(blocks, 16, 4, 11) == tunnel);
+    CHECK(ChunkConnectivity::getReachableOpenings(blocks, 16, 30, 11) == surface);
+    CHECK(ChunkConnectivity::getReachableOpenings(blocks, 16, 6, 11) == 0);
+
+    //A shaft up to the surface joins them
+    fillBox(blocks, 16, 6, 10, 16, SURFACE - 1, 10);
+    connectivity = ChunkConnectivity::compute(blocks);
+    CHECK(connectivity.getConnected(ChunkConnectivity::getOpening(ChunkSide_NegX, 4)) == (tunnel | surface));
+    CHECK(connectivity.getConnected(ChunkConnectivity::TOP) == (tunnel | surface));
+}
+
+//Side openings are connected only when air joins them in their own bands
+static void testSideBands()
+{
+    ChunkStorage blocks = makeSolid();
+    const int band = ChunkConnectivity::BAND_HEIGHT;
+
+    //Round a corner in the third band, from the -z side to the +x side
+    fillBox(blocks, 5, 2 * band + 3, 0, 5, 2 * band + 3, 12);
+    fillBox(blocks, 5, 2 * band + 3, 12, LAST, 2 * band + 3, 12);
+    //Straight across on each side of the first band border, each in its own band
+    fillBox(blocks, 0, band - 1, 20, LAST, band - 1, 20);
+    fillBox(blocks, 0, band, 24, LAST, band, 24);
+    //A step up across the band border, joined through a face
+    fillBox(blocks, 0, band - 1, 28, 15, band - 1, 28);
+    fillBox(blocks, 15, band, 28, LAST, band, 28);
+    //A step up joined only at a corner, which is not a face
+    fillBox(blocks, 0, 2 * band - 1, 3, 10, 2 * band - 1, 3);
+    fillBox(blocks, 11, 2 * band, 4, LAST, 2 * band, 4);
+
+    ChunkConnectivity connectivity = ChunkConnectivity::compute(blocks);
+    uint32_t corner = getOpeningBit(ChunkSide_NegZ, 2 * band) | getOpeningBit(ChunkSide_PosX, 2 * band);
+    CHECK(connectivity.getConnected(ChunkConnectivity::getOpening(ChunkSide_NegZ, 2 * band)) == corner);
+    CHECK(connectivity.getConnected(ChunkConnectivity::getOpening(ChunkSide_PosX, 2 * band)) == corner);
+
+    uint32_t firstBand = getOpeningBit(ChunkSide_NegX, 0) | getOpeningBit(ChunkSide_PosX, 0) | getOpeningBit(ChunkSide_PosX, band);
+    uint32_t secondBand = getOpeningBit(ChunkSide_NegX, band) | getOpeningBit(ChunkSide_PosX, band);
+    CHECK(connectivity.getConnected(ChunkConnectivity::getOpening(ChunkSide_NegX, 0)) == firstBand);
+    CHECK(connectivity.getConnected(ChunkConnectivity::getOpening(ChunkSide_NegX, band)) == secondBand);
+
+    CHECK(ChunkConnectivity::getReachableOpenings(blocks, 5, band - 1, 20) == (getOpeningBit(ChunkSide_NegX, 0) | getOpeningBit(ChunkSide_PosX, 0)));
+    CHECK(ChunkConnectivity::getReachableOpenings(blocks, 5, band, 24) == secondBand);
+    CHECK(ChunkConnectivity::getReachableOpenings(blocks, 5, 2 * band - 1, 3) == getOpeningBit(ChunkSide_NegX, band));
+    CHECK(ChunkConnectivity::getReachableOpenings(blocks, 20, 2 * band, 4) == getOpeningBit(ChunkSide_PosX, 2 * band));
+}
+
+//Random caves of several densities against a block by block flood fill, in both storage modes
+static void testAgainstReference()
+{
+    std::mt19937 random(7);
+    for(float airChance : {0.2f, 0.3f, 0.45f, 0.7f}){
+        std::bernoulli_distribution isAir(airChance);
+        for(ChunkStorageMode mode : {ChunkStorageMode_Flat, ChunkStorageMode_Palette}){
+            ChunkStorage blocks = makeSolid(mode);
+            for(int x = 0; x < CHUNK_SIZE; x++){
+                for(int y = 0; y < CHUNK_SIZE; y++){
+                    for(int z = 0; z < CHUNK_SIZE; z++){
+                        if(isAir(random)) blocks.set(x, y, z, BlockId_Air);
+                    }
+                }
+            }
+
+            uint32_t expected[ChunkConnectivity::OPENING_COUNT];
+            getReferenceConnected(blocks, expected);
+            ChunkConnectivity connectivity = ChunkConnectivity::compute(blocks);
+            for(int opening = 0; opening < ChunkConnectivity::OPENING_COUNT; opening++){
+                CHECK(connectivity.getConnected(opening) == expected[opening]);
+            }
+        }
+    }
+}
+
+//3 x 3 chunks, solid apart from tunnels carved through World, every mesh and connectivity up to date
+static void setupSolidWorld(World &world)
+{
+    for(int i = 0; i < world.getSize(); i++){
+        for(int j = 0; j < world.getSize(); j++){
+            world.loadChunk(i, j);
+        }
+    }
+    world.finishJobs();
+    for(int i = 0; i < world.getSize(); i++){
+        for(int j = 0; j < world.getSize(); j++){
+            fillBox(world, i, j, 0, 0, 0, LAST, LAST, LAST, true);
+        }
+    }
+}
+
+static bool isConnectivityCurrent(const World &world)
+{
+    bool current = true;
+    for(int i = 0; i < world.getSize(); i++){
+        for(int j = 0; j < world.getSize(); j++){
+            current = current && isSame(world.getConnectivity(i, j), ChunkConnectivity::compute(world.getChunk(i, j)->getStorage()));
+        }
+    }
+    return current;
+}
+
+//A tunnel leads from the camera's chunk into its +x neighbour and turns back through another band. The way
+//back into the camera's chunk is a turn a line of sight cannot take, so the -x chunk behind it is not visible
+//until the camera's own tunnel reaches it.
+static void testVisibleChunks()
+{
+    World world(3, ChunkStorageMode_Flat, 1);
+    setupSolidWorld(world);
+    const int band = ChunkConnectivity::BAND_HEIGHT;
+    //The camera's chunk (1, 1): its tunnel in the first band to +x, another in the second band through it
+    fillBox(world, 1, 1, 10, 4, 16, LAST, 4, 16, false);
+    fillBox(world, 1, 1, 0, band + 4, 16, LAST, band + 4, 16, false);
+    //(2, 1) on +x: a U turn from the first band to the second, both on its -x side
+    fillBox(world, 2, 1, 0, 4, 16, 10, 4, 16, false);
+    fillBox(world, 2, 1, 10, 4, 16, 10, band + 4, 16, false);
+    fillBox(world, 2, 1, 0, band + 4, 16, 10, band + 4, 16, false);
+    world.finishJobs();
+    CHECK(isConnectivityCurrent(world));
+
+    std::vector<bool> visible;
+    world.findVisibleChunks(1, 1, 10, 4, 16, visible);
+    for(int index = 0; index < 9; index++){
+        CHECK(visible[index] == (index == 1 * 3 + 1 || index == 2 * 3 + 1));
+    }
+
+    //Joining the camera's tunnel to the second one opens the -x side
+    fillBox(world, 1, 1, 20, 4, 16, 20, band + 4, 16, false);
+    world.finishJobs();
+    CHECK(isConnectivityCurrent(world));
+    world.findVisibleChunks(1, 1, 10, 4, 16, visible);
+    CHECK(visible[0 * 3 + 1]);
+    CHECK(!visible[0 * 3 + 0] && !visible[1 * 3 + 2]);
+
+    //And closing it again hides it
+    world.setBlock(1, 1, 20, band, 16, BlockType_Stone);
+    world.finishJobs();
+    CHECK(isConnectivityCurrent(world));
+    world.findVisibleChunks(1, 1, 10, 4, 16, visible);
+    CHECK(!visible[0 * 3 + 1]);
+    CHECK(visible[2 * 3 + 1]);
+
+    //A camera above the chunks sees every one
+    world.findVisibleChunks(1, 1, 10, CHUNK_SIZE, 16, visible);
+    CHECK(visible == std::vector<bool>(9, true));
+}
+
+//The generated chunk's meshing is still queued when an edit is meshed on the main thread, so its result
+//arrives last. It saw the blocks before the edit and must not replace the connectivity the edit gave.
+static void testStaleConnectivityDropped()
+{
+    World world(1, ChunkStorageMode_Flat, 1);
+    world.loadChunk(0, 0);
+    while(!world.getChunk(0, 0)){
+        world.processJobs();
+    }
+    ChunkConnectivity generated = ChunkConnectivity::compute(world.getChunk(0, 0)->getStorage());
+
+    //A shaft from the bottom to the top
+    fillBox(world, 0, 0, 5, 0, 5, 5, LAST, 5, false);
+    world.finishJobs();
+    ChunkConnectivity edited = ChunkConnectivity::compute(world.getChunk(0, 0)->getStorage());
+    CHECK(!isSame(generated, edited));
+    CHECK(isSame(world.getConnectivity(0, 0), edited));
+}
+
+void runChunkConnectivityTests()
+{
+    testUniformChunks();
+    testSealedTunnel();
+    testSideBands();
+    testAgainstReference();
+    testVisibleChunks();
+    testStaleConnectivityDropped();
+}
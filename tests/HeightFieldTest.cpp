@@ -0,0 +1,67 @@
+#include "Tests.h"
+#include "HeightField.h"
+
+#include <cstring>
+#include <vector>
+
+static const int TILE_SIZE = HeightField::TILE_SIZE;
+
+//Windows as x0, z0, width, depth and the tiles they cover
+static const int WINDOWS[][5] = {
+    {-100, -37, 50, 20, 2},                            // negative coordinates
+    {-TILE_SIZE, -TILE_SIZE, TILE_SIZE, TILE_SIZE, 1}, // exactly the tile below 0 on both axes
+    {40, -30, TILE_SIZE, TILE_SIZE, 4},                // 2 x 2 tiles
+    {-10, -10, 20, 20, 4},                             // 2 x 2 tiles around 0
+    {TILE_SIZE - 1, 0, 1, 1, 1},                       // single points on either side of tile edges
+    {TILE_SIZE, 0, 1, 1, 1},
+    {-1, -1, 1, 1, 1},
+    {-TILE_SIZE, 2 * TILE_SIZE - 1, 1, 1, 1},
+    {-TILE_SIZE - 1, TILE_SIZE, 1, 1, 1},
+};
+
+//The window copied out of the tiles is bit for bit what the generator gives for the same region
+static bool isSameAsGenerator(HeightField &heightField, const TerrainGenerator &terrain, const int *window)
+{
+    int width = window[2], depth = window[3];
+    std::vector<float> heights(width * depth), expected(width * depth);
+    heightField.getHeights(window[0], window[1], width, depth, heights.data());
+    terrain.getGridHeights(window[0], window[1], width, depth, expected.data());
+    return std::memcmp(heights.data(), expected.data(), heights.size() * sizeof(float)) == 0;
+}
+
+static void testWindows()
+{
+    //Full resolution and coarse octaves, whose lattices do not line up with every window
+    for(float coarseErrorBound : {0.0f, 0.05f}){
+        TerrainGenerator terrain(HeightSource_Batch, coarseErrorBound);
+        for(const int *window : WINDOWS){
+            HeightTileCache cache;
+            HeightField heightField(terrain, cache);
+            CHECK(isSameAsGenerator(heightField, terrain, window));
+            CHECK(heightField.getStats().tilesGenerated == window[4]);
+        }
+    }
+}
+
+//Windows cut from tiles generated for other windows give the same heights
+static void testSharedTiles()
+{
+    TerrainGenerator terrain;
+    HeightTileCache cache;
+    HeightField heightField(terrain, cache);
+    for(const int *window : WINDOWS){
+        CHECK(isSameAsGenerator(heightField, terrain, window));
+    }
+    int tilesGenerated = heightField.getStats().tilesGenerated;
+    for(const int *window : WINDOWS){
+        CHECK(isSameAsGenerator(heightField, terrain, window));
+    }
+    CHECK(heightField.getStats().tilesGenerated == tilesGenerated);
+    CHECK(heightField.getStats().samplesGenerated == (long long)tilesGenerated * TILE_SIZE * TILE_SIZE);
+}
+
+void runHeightFieldTests()
+{
+    testWindows();
+    testSharedTiles();
+}
@@ -0,0 +1,174 @@
+#include "Tests.h"
+#include "HeightField.h"
+
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <random>
+#include <thread>
+#include <vector>
+
+typedef std::shared_ptr<HeightTileCache::Tile> TilePointer;
+
+static bool hasStats(HeightTileCache &cache, int tiles, long long hits, long long misses, long long evictions)
+{
+    HeightTileCacheStats stats = cache.getStats();
+    return stats.tiles == tiles && stats.hits == hits && stats.misses == misses && stats.evictions == evictions;
+}
+
+//Past capacity the least recently requested tile goes first
+static void testEvictionOrder()
+{
+    HeightTileCache cache(3);
+    TilePointer a = cache.getTile(1, 0, 0), b = cache.getTile(1, 1, 0), c = cache.getTile(1, 0, 1);
+    CHECK(hasStats(cache, 3, 0, 3, 0));
+    TilePointer d = cache.getTile(1, 1, 1);
+    CHECK(hasStats(cache, 3, 0, 4, 1));
+    //c and d are still held. a was dropped, it comes back as a new tile and evicts b.
+    CHECK(cache.getTile(1, 0, 1) == c);
+    CHECK(cache.getTile(1, 1, 1) == d);
+    CHECK(cache.getTile(1, 0, 0) != a);
+    CHECK(hasStats(cache, 3, 2, 5, 2));
+    CHECK(cache.getTile(1, 1, 0) != b);
+    CHECK(hasStats(cache, 3, 2, 6, 3));
+
+    //Dropped tiles stay valid for whoever still holds them
+    a->heights.assign(4, 1.0f);
+    CHECK(a->heights.size() == 4);
+
+    cache.clear();
+    CHECK(hasStats(cache, 0, 2, 6, 3));
+    CHECK(cache.getTile(1, 0, 1) != c);
+    CHECK(hasStats(cache, 1, 2, 7, 3));
+}
+
+static void testCapacityOne()
+{
+    HeightTileCache cache(1);
+    TilePointer a = cache.getTile(1, 0, 0);
+    CHECK(cache.getTile(1, 0, 0) == a);
+    CHECK(hasStats(cache, 1, 1, 1, 0));
+    TilePointer b = cache.getTile(1, 0, 1);
+    CHECK(b != a);
+    CHECK(cache.getTile(1, 0, 0) != a);
+    CHECK(cache.getTile(1, 0, 1) != b);
+    CHECK(hasStats(cache, 1, 1, 4, 3));
+
+    //Capacities below 1 are raised to it
+    CHECK(HeightTileCache(0).getStats().capacity == 1);
+    CHECK(HeightTileCache(-5).getStats().capacity == 1);
+}
+
+//A hit moves the tile to the front, so the next eviction takes the one behind it
+static void testHitMovesToFront()
+{
+    HeightTileCache cache(3);
+    TilePointer a = cache.getTile(1, 0, 0), b = cache.getTile(1, 1, 0), c = cache.getTile(1, 2, 0);
+    CHECK(cache.getTile(1, 0, 0) == a);
+    cache.getTile(1, 3, 0);
+    CHECK(cache.getTile(1, 0, 0) == a);
+    CHECK(cache.getTile(1, 2, 0) == c);
+    CHECK(hasStats(cache, 3, 3, 4, 1));
+    CHECK(cache.getTile(1, 1, 0) != b);
+    CHECK(hasStats(cache, 3, 3, 5, 2));
+}
+
+//Random requests against a list of keys kept in use order: the same tiles are held and every count is exact
+static void testAgainstReference()
+{
+    std::mt19937 random(5);
+    for(int capacity : {1, 3, 16}){
+        HeightTileCache cache(capacity);
+        std::deque<int> held; // most recently used first
+        std::vector<TilePointer> tiles(40);
+        long long hits = 0, misses = 0, evictions = 0;
+        bool same = true;
+        for(int request = 0; request < 20000; request++){
+            //Generators 0 to 2, each with the same tiles on both sides of 0
+            int key = random() % 40;
+            TilePointer tile = cache.getTile(key % 3, key / 3 - 6, 6 - key / 3);
+            auto found = std::find(held.begin(), held.end(), key);
+            if(found != held.end()){
+                hits++;
+                held.erase(found);
+                same = same && tile == tiles[key];
+            }
+            else{
+                misses++;
+                same = same && tile != tiles[key];
+                tiles[key] = tile;
+            }
+            held.push_front(key);
+            if((int)held.size() > capacity){
+                held.pop_back();
+                evictions++;
+            }
+        }
+        CHECK(same);
+        CHECK(hasStats(cache, (int)held.size(), hits, misses, evictions));
+    }
+}
+
+//Generators with different keys keep apart tiles at the same coordinates
+static void testGeneratorKeys()
+{
+    TerrainGenerator terrains[] = {TerrainGenerator(HeightSource_Batch), TerrainGenerator(HeightSource_Batch, 0.05f),
+                                   TerrainGenerator(HeightSource_Batch, 0.2f), TerrainGenerator(HeightSource_Libnoise)};
+    const int TERRAIN_COUNT = sizeof(terrains) / sizeof(terrains[0]);
+    HeightTileCache cache;
+    std::vector<TilePointer> tiles;
+    for(const TerrainGenerator &terrain : terrains){
+        tiles.push_back(cache.getTile(terrain.getKey(), -1, 2));
+    }
+    for(int a = 0; a < TERRAIN_COUNT; a++){
+        for(int b = a + 1; b < TERRAIN_COUNT; b++){
+            CHECK(terrains[a].getKey() != terrains[b].getKey());
+            CHECK(tiles[a] != tiles[b]);
+        }
+    }
+    CHECK(hasStats(cache, TERRAIN_COUNT, 0, TERRAIN_COUNT, 0));
+
+    //Height fields sharing the cache each get their own generator's heights
+    const int SIZE = HeightField::TILE_SIZE;
+    for(const TerrainGenerator &terrain : terrains){
+        HeightField heightField(terrain, cache);
+        std::vector<float> heights(SIZE * SIZE), expected(SIZE * SIZE);
+        heightField.getHeights(-SIZE, 2 * SIZE, SIZE, SIZE, heights.data());
+        terrain.getGridHeights(-SIZE, 2 * SIZE, SIZE, SIZE, expected.data());
+        CHECK(std::memcmp(heights.data(), expected.data(), heights.size() * sizeof(float)) == 0);
+    }
+}
+
+//Threads requesting from a small cache, each tile generated once by whoever gets it first
+static void testThreads()
+{
+    HeightTileCache cache(8);
+    std::vector<std::thread> threads;
+    std::vector<int> wrongSizes(4, 0);
+    for(int t = 0; t < 4; t++){
+        threads.emplace_back([&cache, &wrongSizes, t]{
+            std::mt19937 random(t);
+            for(int request = 0; request < 20000; request++){
+                TilePointer tile = cache.getTile(1, random() % 12, 0);
+                std::call_once(tile->generated, [&]{ tile->heights.assign(4, 1.0f); });
+                if(tile->heights.size() != 4) wrongSizes[t]++;
+            }
+        });
+    }
+    for(std::thread &thread : threads) thread.join();
+    for(int wrong : wrongSizes) CHECK(wrong == 0);
+    HeightTileCacheStats stats = cache.getStats();
+    CHECK(stats.hits + stats.misses == 4 * 20000);
+    CHECK(stats.misses - stats.evictions == stats.tiles);
+    CHECK(stats.tiles <= 8);
+}
+
+void runHeightTileCacheTests()
+{
+    testEvictionOrder();
+    testCapacityOne();
+    testHitMovesToFront();
+    testAgainstReference();
+    testGeneratorKeys();
+    testThreads();
+}
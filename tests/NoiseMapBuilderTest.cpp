@@ -0,0 +1,81 @@
+#include "Tests.h"
+#include "noiseutils.h"
+#include "ThreadPool.h"
+
+#include <cstring>
+#include <thread>
+#include <vector>
+
+//Rows and threads the build callback was called with, in call order
+static std::vector<int> callbackRows;
+static std::vector<std::thread::id> callbackThreads;
+
+static void recordRow(int row)
+{
+    callbackRows.push_back(row);
+    callbackThreads.push_back(std::this_thread::get_id());
+}
+
+static void buildMap(const noise::module::Perlin &perlin, int width, int height, bool seamless, ThreadPool *pool, utils::NoiseMap &map)
+{
+    callbackRows.clear();
+    callbackThreads.clear();
+    utils::NoiseMapBuilderPlane builder;
+    builder.SetSourceModule(perlin);
+    builder.SetDestNoiseMap(map);
+    builder.SetDestSize(width, height);
+    builder.SetBounds(-3.7, 5.2, 11.0, 13.5);
+    builder.EnableSeamless(seamless);
+    builder.SetCallback(recordRow);
+    builder.SetThreadPool(pool);
+    builder.Build();
+}
+
+static bool isSameMap(const utils::NoiseMap &a, const utils::NoiseMap &b)
+{
+    if(a.GetWidth() != b.GetWidth() || a.GetHeight() != b.GetHeight()) return false;
+    for(int row = 0; row < a.GetHeight(); row++){
+        if(std::memcmp(a.GetConstSlabPtr(row), b.GetConstSlabPtr(row), a.GetWidth() * sizeof(float)) != 0) return false;
+    }
+    return true;
+}
+
+//Every row exactly once, in order, on the thread that called Build
+static bool isRowOrderKept(int height)
+{
+    bool kept = (int)callbackRows.size() == height;
+    for(int row = 0; kept && row < height; row++){
+        kept = callbackRows[row] == row && callbackThreads[row] == std::this_thread::get_id();
+    }
+    return kept;
+}
+
+//Rows filled on the pool give the same bits as one thread filling them in order
+static void testPooledMatchesSerial()
+{
+    noise::module::Perlin perlin;
+    perlin.SetFrequency(0.37);
+    //A plain map, one row, and fewer rows than workers
+    const int sizes[][2] = {{64, 48}, {33, 1}, {20, 3}};
+    ThreadPool smallPool(2), largePool(8);
+
+    for(const int *size : sizes){
+        for(bool seamless : {false, true}){
+            utils::NoiseMap serial;
+            buildMap(perlin, size[0], size[1], seamless, nullptr, serial);
+            CHECK(isRowOrderKept(size[1]));
+
+            for(ThreadPool *pool : {&smallPool, &largePool}){
+                utils::NoiseMap pooled;
+                buildMap(perlin, size[0], size[1], seamless, pool, pooled);
+                CHECK(isSameMap(serial, pooled));
+                CHECK(isRowOrderKept(size[1]));
+            }
+        }
+    }
+}
+
+void runNoiseMapBuilderTests()
+{
+    testPooledMatchesSerial();
+}
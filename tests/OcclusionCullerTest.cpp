@@ -0,0 +1,115 @@
+#include "Tests.h"
+#include "OcclusionCuller.h"
+
+#include <cstring>
+#include <glm/gtc/matrix_transform.hpp>
+#include <random>
+
+//Camera at the origin looking down -z, as the main view projects
+static glm::mat4 getViewMatrix()
+{
+    return glm::perspective(glm::radians(60.0f), 4.0f / 3.0f, 0.1f, 100.0f);
+}
+
+//A wall 20 wide and tall, 5 to 6 in front of the camera
+static void addWall(OcclusionCuller &culler)
+{
+    culler.addOccluder(glm::vec3(-10.0f, -10.0f, -6.0f), glm::vec3(10.0f, 10.0f, -5.0f));
+}
+
+static void testHiddenBehindOccluder()
+{
+    OcclusionCuller culler;
+    culler.begin(getViewMatrix());
+    addWall(culler);
+    CHECK(culler.getStats().occluders == 1);
+    CHECK(!culler.isVisible(glm::vec3(-1.0f, -1.0f, -12.0f), glm::vec3(1.0f, 1.0f, -10.0f)));
+    CHECK(!culler.isVisible(glm::vec3(-3.0f, -2.0f, -50.0f), glm::vec3(3.0f, 2.0f, -20.0f)));
+    CHECK(culler.getStats().occluded == 2);
+}
+
+static void testVisibleBoxes()
+{
+    OcclusionCuller culler;
+    culler.begin(getViewMatrix());
+    addWall(culler);
+    //In front of the wall
+    CHECK(culler.isVisible(glm::vec3(-1.0f, -1.0f, -4.0f), glm::vec3(1.0f, 1.0f, -3.0f)));
+    //Touching the wall's front face, never hidden by the surface it lies on
+    CHECK(culler.isVisible(glm::vec3(-1.0f, -1.0f, -5.0f), glm::vec3(1.0f, 1.0f, -4.5f)));
+    //Crossing the near plane, and around the camera
+    CHECK(culler.isVisible(glm::vec3(-1.0f, -1.0f, -12.0f), glm::vec3(1.0f, 1.0f, 0.05f)));
+    CHECK(culler.isVisible(glm::vec3(-1.0f, -1.0f, -1.0f), glm::vec3(1.0f, 1.0f, 1.0f)));
+
+    //Beside a narrow pillar, in view but where the pillar does not reach
+    OcclusionCuller pillarCuller;
+    pillarCuller.begin(getViewMatrix());
+    pillarCuller.addOccluder(glm::vec3(-2.0f, -2.0f, -6.0f), glm::vec3(2.0f, 2.0f, -5.0f));
+    CHECK(pillarCuller.isVisible(glm::vec3(6.0f, -1.0f, -12.0f), glm::vec3(7.0f, 1.0f, -10.0f)));
+    //Partly behind it
+    CHECK(pillarCuller.isVisible(glm::vec3(0.0f, -1.0f, -12.0f), glm::vec3(7.0f, 1.0f, -10.0f)));
+    CHECK(!pillarCuller.isVisible(glm::vec3(-1.0f, -1.0f, -12.0f), glm::vec3(1.0f, 1.0f, -10.0f)));
+}
+
+static void testOccluderCrossingNearPlane()
+{
+    //Skipped instead of rasterized, so it hides nothing
+    OcclusionCuller culler;
+    culler.begin(getViewMatrix());
+    culler.addOccluder(glm::vec3(-10.0f, -10.0f, -6.0f), glm::vec3(10.0f, 10.0f, 1.0f));
+    CHECK(culler.getStats().skippedOccluders == 1);
+    CHECK(culler.getStats().occluders == 0);
+    CHECK(culler.isVisible(glm::vec3(-1.0f, -1.0f, -12.0f), glm::vec3(1.0f, 1.0f, -10.0f)));
+}
+
+//Random occluders and boxes in random views: the SSE2 and scalar paths must give the same depth buffer and answers
+static void testSimdMatchesScalar()
+{
+    if(!OcclusionCuller::hasSimd()){
+        std::cout << "OcclusionCuller: SSE2 path not compiled in, only the scalar path was tested\n";
+        return;
+    }
+
+    const int VIEW_COUNT = 50;
+    const int OCCLUDER_COUNT = 20;
+    const int BOX_COUNT = 200;
+    std::mt19937 random(11);
+    std::uniform_real_distribution<float> position(-20.0f, 20.0f), extent(0.2f, 6.0f), angle(-3.14159f, 3.14159f);
+
+    OcclusionCuller simd, scalar;
+    scalar.setSimdEnabled(false);
+    CHECK(simd.isSimdEnabled() && !scalar.isSimdEnabled());
+    int different = 0, occluded = 0;
+    for(int view = 0; view < VIEW_COUNT; view++){
+        glm::mat4 matrix = getViewMatrix() * glm::rotate(glm::mat4(1.0f), angle(random), glm::vec3(0.0f, 1.0f, 0.0f)) *
+                           glm::translate(glm::mat4(1.0f), glm::vec3(position(random), position(random) * 0.2f, position(random)));
+        simd.begin(matrix);
+        scalar.begin(matrix);
+        for(int o = 0; o < OCCLUDER_COUNT; o++){
+            glm::vec3 min(position(random), position(random), position(random));
+            glm::vec3 max = min + glm::vec3(extent(random), extent(random), extent(random));
+            simd.addOccluder(min, max);
+            scalar.addOccluder(min, max);
+        }
+        different += std::memcmp(simd.getDepthBuffer(), scalar.getDepthBuffer(), sizeof(float) * OcclusionCuller::WIDTH * OcclusionCuller::HEIGHT) != 0;
+        for(int b = 0; b < BOX_COUNT; b++){
+            glm::vec3 min(position(random), position(random), position(random));
+            glm::vec3 max = min + glm::vec3(extent(random), extent(random), extent(random));
+            bool visible = simd.isVisible(min, max);
+            different += visible != scalar.isVisible(min, max);
+            occluded += !visible;
+        }
+    }
+    CHECK(different == 0);
+    //The views must exercise both answers for the comparison to mean anything
+    CHECK(occluded > 0);
+    CHECK(occluded < VIEW_COUNT * BOX_COUNT);
+}
+
+void runOcclusionCullerTests()
+{
+    testHiddenBehindOccluder();
+    testVisibleBoxes();
+    testOccluderCrossingNearPlane();
+    testSimdMatchesScalar();
+}
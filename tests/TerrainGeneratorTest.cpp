@@ -0,0 +1,91 @@
+#include "Tests.h"
+#include "TerrainGenerator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+static const float COARSE_ERROR_BOUNDS[] = {0.002f, 0.005f, 0.02f, 0.05f, 0.2f};
+
+//Regions on both sides of 0 and off the coarse lattices, as x0, z0, width, depth
+static const int REGIONS[][4] = {{0, 0, 256, 256}, {-333, -517, 300, 200}, {1021, -4099, 190, 210}, {-6, 3, 1, 1}};
+
+//Sampling every octave at every point gives the batch source's heights unchanged
+static void testFullResolution()
+{
+    TerrainGenerator terrain;
+    CHECK(terrain.getCoarseError() == 0.0f);
+    for(int octave = 0; octave < noise::module::DEFAULT_PERLIN_OCTAVE_COUNT; octave++){
+        CHECK(terrain.getOctaveSpacing(octave) == 1);
+    }
+
+    noise::module::Perlin perlin;
+    perlin.SetFrequency(0.01);
+    BatchPerlin batch(perlin);
+    const int SIZE = 64;
+    std::vector<float> heights(SIZE * SIZE), expected(SIZE * SIZE), xs(SIZE), zs(SIZE);
+    terrain.getGridHeights(-20, 7, SIZE, SIZE, heights.data());
+    for(int z = 0; z < SIZE; z++){
+        for(int x = 0; x < SIZE; x++){
+            xs[x] = (float)(-20 + x);
+            zs[x] = (float)(7 + z);
+        }
+        batch.getValues(xs.data(), zs.data(), SIZE, &expected[z * SIZE]);
+    }
+    CHECK(std::memcmp(heights.data(), expected.data(), heights.size() * sizeof(float)) == 0);
+}
+
+//The measured deviation from full resolution stays within getCoarseError() for every bound
+static void testCoarseErrorEstimate()
+{
+    TerrainGenerator fullTerrain;
+    for(float bound : COARSE_ERROR_BOUNDS){
+        TerrainGenerator terrain(HeightSource_Batch, bound);
+        CHECK(terrain.getCoarseError() <= bound);
+        CHECK(terrain.getOctaveSpacing(0) > 1);
+        CHECK(terrain.getKey() != fullTerrain.getKey());
+
+        for(const int *region : REGIONS){
+            int width = region[2], depth = region[3];
+            std::vector<float> heights(width * depth), fullHeights(width * depth);
+            terrain.getGridHeights(region[0], region[1], width, depth, heights.data());
+            fullTerrain.getGridHeights(region[0], region[1], width, depth, fullHeights.data());
+            float maxDifference = 0.0f;
+            for(int k = 0; k < width * depth; k++){
+                maxDifference = std::max(maxDifference, std::abs(heights[k] - fullHeights[k]));
+            }
+            CHECK(maxDifference <= terrain.getCoarseError());
+        }
+    }
+}
+
+//A point gets the same height whatever region it is generated with
+static void testRegionIndependence()
+{
+    TerrainGenerator terrain(HeightSource_Batch, 0.2f);
+    const int X0 = -70, Z0 = -45, WIDTH = 100, DEPTH = 90;
+    std::vector<float> heights(WIDTH * DEPTH);
+    terrain.getGridHeights(X0, Z0, WIDTH, DEPTH, heights.data());
+
+    //Sub-regions starting on and off every lattice, down to single points
+    const int subRegions[][4] = {{0, 0, 100, 90}, {13, 7, 37, 29}, {6, 6, 8, 8}, {61, 2, 1, 1}, {70, 45, 1, 1}, {99, 89, 1, 1}};
+    for(const int *sub : subRegions){
+        std::vector<float> subHeights(sub[2] * sub[3]);
+        terrain.getGridHeights(X0 + sub[0], Z0 + sub[1], sub[2], sub[3], subHeights.data());
+        bool same = true;
+        for(int z = 0; z < sub[3]; z++){
+            for(int x = 0; x < sub[2]; x++){
+                same = same && subHeights[z * sub[2] + x] == heights[(sub[1] + z) * WIDTH + sub[0] + x];
+            }
+        }
+        CHECK(same);
+    }
+}
+
+void runTerrainGeneratorTests()
+{
+    testFullResolution();
+    testCoarseErrorEstimate();
+    testRegionIndependence();
+}
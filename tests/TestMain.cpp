@@ -0,0 +1,21 @@
+#include "Tests.h"
+
+int testFailures = 0;
+
+int main()
+{
+    runOcclusionCullerTests();
+    runBatchPerlinTests();
+    runTerrainGeneratorTests();
+    runChunkConnectivityTests();
+    runNoiseMapBuilderTests();
+    runHeightFieldTests();
+    runHeightTileCacheTests();
+
+    if(testFailures > 0){
+        std::cerr << testFailures << " checks failed\n";
+        return 1;
+    }
+    std::cout << "All tests passed\n";
+    return 0;
+}
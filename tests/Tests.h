@@ -0,0 +1,26 @@
+#ifndef __TESTS_H__
+#define __TESTS_H__
+
+#include <iostream>
+
+//Checks that need no window or GL context, built by the "build tests" task of .vscode/tasks.json and run with
+//./tests/runTests. A failed CHECK prints its condition and location, and the run exits with 1.
+extern int testFailures;
+
+#define CHECK(condition) \
+    do { \
+        if(!(condition)){ \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": CHECK(" #condition ") failed\n"; \
+            testFailures++; \
+        } \
+    } while(0)
+
+void runOcclusionCullerTests();
+void runBatchPerlinTests();
+void runTerrainGeneratorTests();
+void runChunkConnectivityTests();
+void runNoiseMapBuilderTests();
+void runHeightFieldTests();
+void runHeightTileCacheTests();
+
+#endif // __TESTS_H__